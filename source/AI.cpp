@@ -30,6 +30,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Hardpoint.h"
 #include "Hasher.h"
 #include "JumpType.h"
+#include "Logger.h"
 #include "image/Mask.h"
 #include "Messages.h"
 #include "Minable.h"
@@ -39,6 +40,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Point.h"
 #include "Port.h"
 #include "Preferences.h"
+#include "Profiler.h"
 #include "Random.h"
 #include "RoutePlan.h"
 #include "ScanType.h"
@@ -48,6 +50,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "ShipJumpNavigation.h"
 #include "StellarObject.h"
 #include "System.h"
+#include "TaskQueue.h"
 #include "UI.h"
 #include "Weapon.h"
 #include "Wormhole.h"
@@ -71,6 +74,16 @@ namespace {
 		return cancelers;
 	}
 
+	// Check whether the given ship may consider the other ship when it is looking
+	// for targets or allies in its system.
+	bool IsListed(const Ship &ship, const Ship &other)
+	{
+		return other.IsTargetable() && other.GetSystem() == ship.GetSystem()
+				&& !(other.IsHyperspacing() && other.Velocity().Length() > 10.)
+				&& (ship.IsYours() || !other.GetPersonality().IsMarked())
+				&& (other.IsYours() || !ship.GetPersonality().IsMarked());
+	}
+
 	bool NeedsFuel(const Ship &ship)
 	{
 		return ship.GetSystem() && !ship.IsEnteringHyperspace() && !ship.GetSystem()->HasFuelFor(ship)
@@ -716,8 +729,10 @@ void AI::ClearOrders()
 
 
 
-void AI::Step(Command &activeCommands)
+void AI::Step(Command &activeCommands, TaskQueue &queue)
 {
+	Profiler::Scope scope("AI::Step");
+
 	// First, figure out the comparative strengths of the present governments.
 	const System *playerSystem = player.GetSystem();
 	map<const Government *, int64_t> strength;
@@ -766,6 +781,12 @@ void AI::Step(Command &activeCommands)
 	bool opportunisticEscorts = !Preferences::Has("Turrets focus fire");
 	bool fightersRetreat = Preferences::Has("Damaged fighters retreat");
 	const int npcMaxMiningTime = GameData::GetGamerules().NPCMaxMiningTime();
+	// Turret aiming and automatic fire can be decided after all the other
+	// decisions are made, spread over the worker threads. Only those decisions
+	// are deferred: the rest of what each ship does is decided here, in order,
+	// since it changes the state that the next ship's decisions read.
+	const bool deferFiring = Preferences::Has("Parallel AI");
+	firingTasks.clear();
 	for(const auto &it : ships)
 	{
 		// A destroyed ship can't do anything.
@@ -893,11 +914,34 @@ void AI::Step(Command &activeCommands)
 		}
 		if(isPresent)
 		{
-			AimTurrets(*it, firingCommands, it->IsYours() ? opportunisticEscorts : personality.IsOpportunistic());
-			if(targetAsteroid)
-				AutoFire(*it, firingCommands, *targetAsteroid);
+			bool opportunistic = it->IsYours() ? opportunisticEscorts : personality.IsOpportunistic();
+			bool isWaitingToJump = it->Commands().Has(Command::JUMP | Command::WAIT);
+			if(deferFiring)
+			{
+				uint64_t seed = static_cast<uint64_t>(Random::Int()) << 32;
+				firingTasks.push_back({it.get(), target, targetAsteroid, opportunistic, isWaitingToJump,
+					seed | Random::Int()});
+#ifndef NDEBUG
+				// Make the decisions here as well, as they would be made without
+				// deferring them, so that the deferred ones can be checked against them.
+				FiringTask &task = firingTasks.back();
+				task.inlineCommand = firingCommands;
+				Random::Stream stream(task.seed);
+				AimTurrets(*it, target.get(), targetAsteroid.get(), task.inlineCommand, opportunistic);
+				if(targetAsteroid)
+					AutoFire(*it, task.inlineCommand, *targetAsteroid);
+				else
+					AutoFire(*it, target, isWaitingToJump, task.inlineCommand);
+#endif
+			}
 			else
-				AutoFire(*it, firingCommands);
+			{
+				AimTurrets(*it, target.get(), targetAsteroid.get(), firingCommands, opportunistic);
+				if(targetAsteroid)
+					AutoFire(*it, firingCommands, *targetAsteroid);
+				else
+					AutoFire(*it, target, isWaitingToJump, firingCommands);
+			}
 		}
 
 		// If this ship is hyperspacing, or in the act of
@@ -905,7 +949,7 @@ void AI::Step(Command &activeCommands)
 		if(it->IsHyperspacing() || it->Zoom() < 1.)
 		{
 			it->SetCommands(command);
-			it->SetCommands(firingCommands);
+			SetFiringCommands(*it);
 			continue;
 		}
 
@@ -985,7 +1029,7 @@ void AI::Step(Command &activeCommands)
 			{
 				it->SetTargetShip(shipToAssist);
 				it->SetCommands(command);
-				it->SetCommands(firingCommands);
+				SetFiringCommands(*it);
 				continue;
 			}
 		}
@@ -1017,7 +1061,7 @@ void AI::Step(Command &activeCommands)
 			// Flock between allied, in-system ships.
 			DoSwarming(*it, command, target);
 			it->SetCommands(command);
-			it->SetCommands(firingCommands);
+			SetFiringCommands(*it);
 			continue;
 		}
 
@@ -1037,7 +1081,7 @@ void AI::Step(Command &activeCommands)
 		{
 			DoSurveillance(*it, command, target);
 			it->SetCommands(command);
-			it->SetCommands(firingCommands);
+			SetFiringCommands(*it);
 			continue;
 		}
 
@@ -1045,7 +1089,7 @@ void AI::Step(Command &activeCommands)
 		if(isPresent && personality.Harvests() && DoHarvesting(*it, command))
 		{
 			it->SetCommands(command);
-			it->SetCommands(firingCommands);
+			SetFiringCommands(*it);
 			continue;
 		}
 
@@ -1064,7 +1108,7 @@ void AI::Step(Command &activeCommands)
 				}
 				DoMining(*it, command);
 				it->SetCommands(command);
-				it->SetCommands(firingCommands);
+				SetFiringCommands(*it);
 				continue;
 			}
 			// Fighters and drones should assist their parent's mining operation if they cannot
@@ -1078,7 +1122,7 @@ void AI::Step(Command &activeCommands)
 					MoveToAttack(*it, command, *minable);
 					AutoFire(*it, firingCommands, *minable);
 					it->SetCommands(command);
-					it->SetCommands(firingCommands);
+					SetFiringCommands(*it);
 					continue;
 				}
 			}
@@ -1176,7 +1220,7 @@ void AI::Step(Command &activeCommands)
 				MoveTo(*it, command, parent->Position(), parent->Velocity(), 40., .8);
 				command |= Command::BOARD;
 				it->SetCommands(command);
-				it->SetCommands(firingCommands);
+				SetFiringCommands(*it);
 				continue;
 			}
 			// If we get here, it means that the ship has not decided to return
@@ -1283,8 +1327,14 @@ void AI::Step(Command &activeCommands)
 		DoScatter(*it, command, scatterTurn == step);
 
 		it->SetCommands(command);
-		it->SetCommands(firingCommands);
+		SetFiringCommands(*it);
 	}
+
+	if(deferFiring)
+		StepFiring(queue);
+
+	// The ships are about to move, so the grid positions will be out of date.
+	shipIndexIsCurrent = false;
 }
 
 
@@ -1807,24 +1857,53 @@ vector<Ship *> AI::GetShipsList(const Ship &ship, bool targetEnemies, double max
 	auto targets = vector<Ship *>();
 
 	// The cached lists are built each step based on the current ships in the player's system.
-	const auto &rosters = targetEnemies ? enemyLists : allyLists;
+	const auto &rosters = targetEnemies ? enemyGovernments : allyGovernments;
 
 	const auto it = rosters.find(ship.GetGovernment());
-	if(it != rosters.end() && !it->second.empty())
+	if(it != rosters.end())
 	{
-		targets.reserve(it->second.size());
+		const Point &p = ship.Position();
+		for(const Government *government : it->second)
+		{
+			if(shipIndexIsCurrent)
+				shipIndex.Circle(government, p, maxRange, targets);
+			else
+				for(Ship *target : shipIndex.All(government))
+					if(p.Distance(target->Position()) < maxRange)
+						targets.emplace_back(target);
+		}
+		erase_if(targets, [&ship](const Ship *target) -> bool { return !IsListed(ship, *target); });
+	}
 
-		const System *here = ship.GetSystem();
+	return targets;
+}
+
+
+
+// Obtain up to the given number of ships matching the desired hostility that
+// also pass the given filter, sorted by their distance from the given ship.
+vector<Ship *> AI::GetNearestShips(const Ship &ship, bool targetEnemies, size_t count, double maxRange,
+	const function<bool(const Ship &)> &filter) const
+{
+	vector<Ship *> targets;
+	if(!shipIndexIsCurrent)
+	{
+		targets = GetShipsList(ship, targetEnemies, maxRange);
+		erase_if(targets, [&filter](const Ship *target) -> bool { return !filter(*target); });
 		const Point &p = ship.Position();
-		for(const auto &target : it->second)
-			if(target->IsTargetable() && target->GetSystem() == here
-					&& !(target->IsHyperspacing() && target->Velocity().Length() > 10.)
-					&& p.Distance(target->Position()) < maxRange
-					&& (ship.IsYours() || !target->GetPersonality().IsMarked())
-					&& (target->IsYours() || !ship.GetPersonality().IsMarked()))
-				targets.emplace_back(target);
+		stable_sort(targets.begin(), targets.end(), [&p](const Ship *a, const Ship *b) -> bool
+			{ return p.Distance(a->Position()) < p.Distance(b->Position()); });
+		if(targets.size() > count)
+			targets.resize(count);
+		return targets;
 	}
 
+	const auto &rosters = targetEnemies ? enemyGovernments : allyGovernments;
+	const auto it = rosters.find(ship.GetGovernment());
+	if(it != rosters.end())
+		shipIndex.Nearest(it->second, ship.Position(), count, maxRange,
+			[&ship, &filter](const Ship &target) -> bool { return IsListed(ship, target) && filter(target); }, targets);
+
 	return targets;
 }
 
@@ -1903,7 +1982,7 @@ bool AI::FollowOrders(Ship &ship, Command &command)
 		if(DoHarvesting(ship, command))
 		{
 			ship.SetCommands(command);
-			ship.SetCommands(firingCommands);
+			SetFiringCommands(ship);
 		}
 		else
 			return false;
@@ -3456,17 +3535,13 @@ bool AI::DoCloak(const Ship &ship, Command &command) const
 	double range = MAX_RANGE;
 	const Ship *nearestEnemy = nullptr;
 	// Find the nearest targetable, in-system enemy that could attack this ship.
-	const auto enemies = GetShipsList(ship, true);
-	for(const auto &foe : enemies)
-		if(!foe->IsDisabled())
-		{
-			double distance = ship.Position().Distance(foe->Position());
-			if(distance < range)
-			{
-				range = distance;
-				nearestEnemy = foe;
-			}
-		}
+	const auto enemies = GetNearestShips(ship, true, 1, MAX_RANGE,
+		[](const Ship &foe) noexcept -> bool { return !foe.IsDisabled(); });
+	if(!enemies.empty())
+	{
+		nearestEnemy = enemies.front();
+		range = ship.Position().Distance(nearestEnemy->Position());
+	}
 
 	// If this ship has started cloaking, it must get at least 40% repaired
 	// or 40% farther away before it begins decloaking again.
@@ -3766,8 +3841,8 @@ Point AI::TargetAim(const Ship &ship, const Body &target)
 
 
 // Aim the given ship's turrets.
-void AI::AimTurrets(const Ship &ship, FireCommand &command, bool opportunistic,
-		const optional<Point> &targetOverride) const
+void AI::AimTurrets(const Ship &ship, const Ship *currentTarget, const Body *targetAsteroid, FireCommand &command,
+		bool opportunistic, const optional<Point> &targetOverride) const
 {
 	// (Position, Velocity) pairs of the targets.
 	vector<pair<Point, Point>> targets;
@@ -3775,7 +3850,6 @@ void AI::AimTurrets(const Ship &ship, FireCommand &command, bool opportunistic,
 	{
 		// First, get the set of potential hostile ships.
 		vector<const Body *> targetBodies;
-		const Ship *currentTarget = ship.GetTargetShip().get();
 		if(opportunistic || !currentTarget || !currentTarget->IsTargetable())
 		{
 			// Find the maximum range of any of this ship's turrets.
@@ -3805,8 +3879,8 @@ void AI::AimTurrets(const Ship &ship, FireCommand &command, bool opportunistic,
 		else
 			targetBodies.push_back(currentTarget);
 		// If this ship is mining, consider aiming at its target asteroid.
-		if(ship.GetTargetAsteroid())
-			targetBodies.push_back(ship.GetTargetAsteroid().get());
+		if(targetAsteroid)
+			targetBodies.push_back(targetAsteroid);
 
 		// If there are no targets to aim at, opportunistic turrets should sweep
 		// back and forth at random, with the sweep centered on the "outward-facing"
@@ -3957,7 +4031,8 @@ void AI::AimTurrets(const Ship &ship, FireCommand &command, bool opportunistic,
 
 
 // Fire whichever of the given ship's weapons can hit a hostile target.
-void AI::AutoFire(const Ship &ship, FireCommand &command, bool secondary, bool isFlagship) const
+void AI::AutoFire(const Ship &ship, shared_ptr<Ship> currentTarget, bool isWaitingToJump, FireCommand &command,
+		bool secondary, bool isFlagship) const
 {
 	const Personality &person = ship.GetPersonality();
 	if(person.IsPacifist() || ship.CannotAct(Ship::ActionType::FIRE))
@@ -3981,7 +4056,6 @@ void AI::AutoFire(const Ship &ship, FireCommand &command, bool secondary, bool i
 	// Special case: your target is not your enemy. Do not fire, because you do
 	// not want to risk damaging that target. Ships will target friendly ships
 	// while assisting and performing surveillance.
-	shared_ptr<Ship> currentTarget = ship.GetTargetShip();
 	const Government *gov = ship.GetGovernment();
 	bool friendlyOverride = false;
 	bool disabledOverride = false;
@@ -4009,9 +4083,6 @@ void AI::AutoFire(const Ship &ship, FireCommand &command, bool secondary, bool i
 	bool plunders = (person.Plunders() && ship.Cargo().Free());
 	bool disables = person.Disables();
 
-	// Don't use weapons with firing force if you are preparing to jump.
-	bool isWaitingToJump = ship.Commands().Has(Command::JUMP | Command::WAIT);
-
 	// Find the longest range of any of your non-homing weapons. Homing weapons
 	// that don't consume ammo may also fire in non-homing mode.
 	double maxRange = 0.;
@@ -4213,6 +4284,90 @@ void AI::AutoFire(const Ship &ship, FireCommand &command, const Body &target) co
 
 
 
+// Give the ship the firing commands built up for it so far. If its aiming and
+// firing decisions were deferred, they are handed over after they are made.
+void AI::SetFiringCommands(Ship &ship)
+{
+	if(!firingTasks.empty() && firingTasks.back().ship == &ship)
+	{
+		firingTasks.back().command = firingCommands;
+		firingTasks.back().apply = true;
+	}
+	else
+		ship.SetCommands(firingCommands);
+}
+
+
+
+// Make the deferred aiming and firing decisions of all ships. Each decision only
+// reads the state of the world, which no longer changes at this point in the
+// step, so they can be made in parallel.
+void AI::StepFiring(TaskQueue &queue)
+{
+	// Bodies cache their animation frame and masks. Update them for every
+	// possible target now, so that the masks are only read from then on.
+	for(const auto &it : ships)
+		it->GetMask(step);
+	for(const FiringTask &task : firingTasks)
+		if(task.targetAsteroid)
+			task.targetAsteroid->GetMask(step);
+
+	queue.ParallelFor(firingTasks.size(), 8, [this](size_t begin, size_t end)
+	{
+		for(size_t i = begin; i < end; ++i)
+			DoFiring(firingTasks[i]);
+	});
+
+#ifndef NDEBUG
+	for(const FiringTask &task : firingTasks)
+		if(!task.matchesInline)
+			Logger::Log("Parallel AI firing decisions differ from the inline ones for \""
+				+ task.ship->GivenName() + "\".", Logger::Level::WARNING);
+#endif
+
+	for(const FiringTask &task : firingTasks)
+		if(task.apply)
+			task.ship->SetCommands(task.command);
+}
+
+
+
+void AI::DoFiring(FiringTask &task) const
+{
+	if(!task.apply)
+		return;
+
+	const Ship &ship = *task.ship;
+	auto decide = [this, &task, &ship](FireCommand &command)
+	{
+		Random::Stream stream(task.seed);
+		AimTurrets(ship, task.target.get(), task.targetAsteroid.get(), command, task.opportunistic);
+		if(task.targetAsteroid)
+			AutoFire(ship, command, *task.targetAsteroid);
+		else
+			AutoFire(ship, task.target, task.isWaitingToJump, command);
+	};
+	decide(task.command);
+
+#ifndef NDEBUG
+	// The commands the ship ended up with may have had other weapons fired since
+	// the point where the inline decisions were made, so compare the decisions
+	// alone, starting from an empty command as that point did.
+	FireCommand deferred;
+	deferred.SetHardpoints(ship.Weapons().size());
+	decide(deferred);
+	for(size_t index = 0; index < ship.Weapons().size(); ++index)
+		if(deferred.HasFire(index) != task.inlineCommand.HasFire(index)
+				|| deferred.Aim(index) != task.inlineCommand.Aim(index))
+		{
+			task.matchesInline = false;
+			break;
+		}
+#endif
+}
+
+
+
 // Get the amount of time it would take the given weapon to reach the given
 // target, assuming it can be fired in any direction (i.e. turreted). For
 // non-turreted weapons this can be used to calculate the ideal direction to
@@ -4790,11 +4945,13 @@ void AI::MovePlayer(Ship &ship, Command &activeCommands)
 	const shared_ptr<const Ship> target = ship.GetTargetShip();
 	auto targetOverride = Preferences::Has("Aim turrets with mouse") ^ activeCommands.Has(Command::AIM_TURRET_HOLD)
 		? optional(mousePosition) : std::nullopt;
-	AimTurrets(ship, firingCommands, !Preferences::Has("Turrets focus fire"), targetOverride);
+	AimTurrets(ship, target.get(), ship.GetTargetAsteroid().get(), firingCommands,
+		!Preferences::Has("Turrets focus fire"), targetOverride);
 	if(Preferences::GetAutoFire() != Preferences::AutoFire::OFF && !ship.IsBoarding()
 			&& !(autoPilot | activeCommands).Has(Command::LAND | Command::JUMP | Command::FLEET_JUMP | Command::BOARD)
 			&& (!target || target->GetGovernment()->IsEnemy()))
-		AutoFire(ship, firingCommands, false, true);
+		AutoFire(ship, ship.GetTargetShip(), ship.Commands().Has(Command::JUMP | Command::WAIT),
+			firingCommands, false, true);
 
 	const bool mouseTurning = activeCommands.Has(Command::MOUSE_TURNING_HOLD);
 	if(mouseTurning && !ship.IsBoarding() && (!ship.IsReversing() || ship.ReverseThrust()))
@@ -5096,21 +5253,20 @@ void AI::UpdateStrengths(map<const Government *, int64_t> &strength, const Syste
 // Cache various lists of all targetable ships in the player's system for this Step.
 void AI::CacheShipLists()
 {
-	allyLists.clear();
-	enemyLists.clear();
+	allyGovernments.clear();
+	enemyGovernments.clear();
+	shipIndex.Clear();
 	for(const auto &git : governmentRosters)
 	{
-		allyLists.emplace(git.first, vector<Ship *>());
-		allyLists.at(git.first).reserve(ships.size());
-		enemyLists.emplace(git.first, vector<Ship *>());
-		enemyLists.at(git.first).reserve(ships.size());
+		auto &allies = allyGovernments[git.first];
+		auto &enemies = enemyGovernments[git.first];
 		for(const auto &oit : governmentRosters)
-		{
-			auto &list = git.first->IsEnemy(oit.first)
-					? enemyLists[git.first] : allyLists[git.first];
-			list.insert(list.end(), oit.second.begin(), oit.second.end());
-		}
+			(git.first->IsEnemy(oit.first) ? enemies : allies).push_back(oit.first);
+		for(Ship *ship : git.second)
+			shipIndex.Add(*ship);
 	}
+	shipIndex.Finish();
+	shipIndexIsCurrent = true;
 }
 
 
@@ -21,8 +21,10 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "orders/OrderSet.h"
 #include "Point.h"
 #include "RoutePlan.h"
+#include "ShipSpatialIndex.h"
 
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -43,6 +45,7 @@ class Ship;
 class ShipEvent;
 class StellarObject;
 class System;
+class TaskQueue;
 
 
 
@@ -76,8 +79,11 @@ public:
 	// Clear ship orders. This should be done when the player lands on a planet,
 	// but not when they jump from one system to another.
 	void ClearOrders();
-	// Issue AI commands to all ships for one game step.
-	void Step(Command &activeCommands);
+	// Issue AI commands to all ships for one game step. If enabled, the aiming
+	// and firing decisions of the ships are spread over the given queue. How the
+	// ships move is always decided one ship at a time, because those decisions
+	// read and write the shared state of the AI and the other ships.
+	void Step(Command &activeCommands, TaskQueue &queue);
 	// Process commands for the player only, called by Step in non-paused mode.
 	void MovePlayer(Ship &ship, Command &activeCommands);
 	void DisengageAutopilot();
@@ -126,6 +132,33 @@ private:
 		std::vector<std::string> wormholeKeys;
 	};
 
+	// Everything needed to decide how a ship aims its turrets and which of its
+	// weapons it fires, captured at the point in the step where it would
+	// otherwise be decided. This lets those decisions be made for all ships at
+	// once, and in parallel, after every ship has decided how to move.
+	class FiringTask {
+	public:
+		Ship *ship;
+		// The targets the ship had when its firing decision would have been made.
+		std::shared_ptr<Ship> target;
+		std::shared_ptr<Minable> targetAsteroid;
+		bool opportunistic;
+		bool isWaitingToJump;
+		// Seed for the random turret sweeps, so that the result does not depend on
+		// which thread handles this task or in what order.
+		uint64_t seed;
+		// Whether the ship took up its firing commands this step. If it did not,
+		// there is no need to work them out.
+		bool apply = false;
+		// The firing commands the ship ended up with, on top of which the aiming
+		// and firing decisions are added.
+		FireCommand command;
+		// In debug builds, the decisions made at the point in the step where they
+		// would otherwise be made, and whether the deferred ones match them.
+		FireCommand inlineCommand;
+		bool matchesInline = true;
+	};
+
 
 private:
 	// Check if a ship can pursue its target (i.e. beyond the "fence").
@@ -139,6 +172,10 @@ private:
 	std::shared_ptr<Ship> FindNonHostileTarget(const Ship &ship) const;
 	// Obtain a list of ships matching the desired hostility.
 	std::vector<Ship *> GetShipsList(const Ship &ship, bool targetEnemies, double maxRange = -1.) const;
+	// Obtain up to the given number of ships matching the desired hostility that
+	// also pass the given filter, sorted by their distance from the given ship.
+	std::vector<Ship *> GetNearestShips(const Ship &ship, bool targetEnemies, size_t count, double maxRange,
+		const std::function<bool(const Ship &)> &filter) const;
 
 	bool FollowOrders(Ship &ship, Command &command);
 	void MoveInFormation(Ship &ship, Command &command);
@@ -190,13 +227,20 @@ private:
 	// returns the direction to the target.
 	static Point TargetAim(const Ship &ship);
 	static Point TargetAim(const Ship &ship, const Body &target);
-	// Aim the given ship's turrets.
-	void AimTurrets(const Ship &ship, FireCommand &command, bool opportunistic = false,
-			const std::optional<Point> &targetOverride = std::nullopt) const;
+	// Aim the given ship's turrets, given the ship and asteroid it is targeting.
+	void AimTurrets(const Ship &ship, const Ship *currentTarget, const Body *targetAsteroid, FireCommand &command,
+			bool opportunistic = false, const std::optional<Point> &targetOverride = std::nullopt) const;
 	// Fire whichever of the given ship's weapons can hit a hostile target.
 	// Return a bitmask giving the weapons to fire.
-	void AutoFire(const Ship &ship, FireCommand &command, bool secondary = true, bool isFlagship = false) const;
+	void AutoFire(const Ship &ship, std::shared_ptr<Ship> currentTarget, bool isWaitingToJump, FireCommand &command,
+			bool secondary = true, bool isFlagship = false) const;
 	void AutoFire(const Ship &ship, FireCommand &command, const Body &target) const;
+	// Give the ship the firing commands built up for it so far. If its aiming and
+	// firing decisions were deferred, they are handed over after they are made.
+	void SetFiringCommands(Ship &ship);
+	// Make the deferred aiming and firing decisions of all ships.
+	void StepFiring(TaskQueue &queue);
+	void DoFiring(FiringTask &task) const;
 
 	// Calculate how long it will take a projectile to reach a target given the
 	// target's relative position and velocity and the velocity of the
@@ -247,6 +291,8 @@ private:
 	// thrashing the heap, since we can reuse the storage for
 	// each ship.
 	FireCommand firingCommands;
+	// Aiming and firing decisions deferred until the end of the step.
+	std::vector<FiringTask> firingTasks;
 
 	bool escortsAreFrugal = true;
 	bool escortsUseAmmo = true;
@@ -287,8 +333,13 @@ private:
 	std::map<const Government *, int64_t> enemyStrength;
 	std::map<const Government *, int64_t> allyStrength;
 	std::map<const Government *, std::vector<Ship *>> governmentRosters;
-	std::map<const Government *, std::vector<Ship *>> enemyLists;
-	std::map<const Government *, std::vector<Ship *>> allyLists;
+	std::map<const Government *, std::vector<const Government *>> enemyGovernments;
+	std::map<const Government *, std::vector<const Government *>> allyGovernments;
+	// The ships in the player's system, sorted into a grid by government. The
+	// grid is only used during Step(), before the ships move away from where
+	// they were when it was built.
+	ShipSpatialIndex shipIndex;
+	bool shipIndexIsCurrent = false;
 
 	// Route planning cache:
 	std::unordered_map<RouteCacheKey, RoutePlan, RouteCacheKey::HashFunction> routeCache;
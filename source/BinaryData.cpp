@@ -0,0 +1,80 @@
+/* BinaryData.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "BinaryData.h"
+
+using namespace std;
+
+
+
+void BinaryWriter::WriteText(string_view text)
+{
+	Write<uint64_t>(text.size());
+	data.append(text);
+}
+
+
+
+// Get everything that was written so far.
+const string &BinaryWriter::Data() const
+{
+	return data;
+}
+
+
+
+BinaryReader::BinaryReader(string_view data)
+	: data(data)
+{
+}
+
+
+
+string_view BinaryReader::ReadText()
+{
+	uint64_t size = Read<uint64_t>();
+	if(data.size() - pos < size)
+	{
+		isValid = false;
+		return {};
+	}
+	pos += size;
+	return data.substr(pos - size, size);
+}
+
+
+
+// Check whether there is room left for the given number of values that
+// each take up at least the given number of bytes.
+bool BinaryReader::HasRoom(uint64_t count, size_t size) const
+{
+	return count <= (data.size() - pos) / size;
+}
+
+
+
+// Check whether every value so far could be read.
+bool BinaryReader::IsValid() const
+{
+	return isValid;
+}
+
+
+
+// Check whether all the data has been read.
+bool BinaryReader::AtEnd() const
+{
+	return pos == data.size();
+}
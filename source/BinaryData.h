@@ -0,0 +1,92 @@
+/* BinaryData.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+
+
+// Helpers for writing and reading the binary forms of cached data. Values are
+// stored in the byte order of the machine that wrote them, since the cached
+// files are never shared between machines.
+class BinaryWriter {
+public:
+	template<class Type>
+	void Write(Type value);
+	void WriteText(std::string_view text);
+
+	// Get everything that was written so far.
+	const std::string &Data() const;
+
+
+private:
+	std::string data;
+};
+
+
+
+// Read values from binary data, keeping track of whether the data ended before
+// all the values could be read. Values that could not be read are zero.
+class BinaryReader {
+public:
+	explicit BinaryReader(std::string_view data);
+
+	template<class Type>
+	Type Read();
+	std::string_view ReadText();
+
+	// Check whether there is room left for the given number of values that
+	// each take up at least the given number of bytes.
+	bool HasRoom(uint64_t count, size_t size) const;
+	// Check whether every value so far could be read.
+	bool IsValid() const;
+	// Check whether all the data has been read.
+	bool AtEnd() const;
+
+
+private:
+	std::string_view data;
+	size_t pos = 0;
+	bool isValid = true;
+};
+
+
+
+template<class Type>
+void BinaryWriter::Write(Type value)
+{
+	data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+
+
+template<class Type>
+Type BinaryReader::Read()
+{
+	Type value{};
+	if(data.size() - pos < sizeof(value))
+		isValid = false;
+	else
+	{
+		std::memcpy(&value, data.data() + pos, sizeof(value));
+		pos += sizeof(value);
+	}
+	return value;
+}
@@ -59,10 +59,19 @@ const Mask &Body::GetMask(int step) const
 	if(!sprite || current < 0)
 		return EMPTY;
 
-	const vector<Mask> &masks = GameData::GetMaskManager().GetMasks(sprite, Scale());
+	// Only look the masks up if they may have changed since the last lookup.
+	const MaskManager &maskManager = GameData::GetMaskManager();
+	unsigned generation = maskManager.Generation();
+	if(!masks || sprite != maskSprite || scale != maskScale || generation != maskGeneration)
+	{
+		masks = &maskManager.GetMasks(sprite, scale);
+		maskSprite = sprite;
+		maskScale = scale;
+		maskGeneration = generation;
+	}
 
 	// Assume that if a masks array exists, it has the right number of frames.
-	return masks.empty() ? EMPTY : masks[current % masks.size()];
+	return masks->empty() ? EMPTY : (*masks)[current % masks->size()];
 }
 
 
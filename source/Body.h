@@ -20,6 +20,8 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Angle.h"
 #include "Point.h"
 
+#include <vector>
+
 class Government;
 class Mask;
 class Sprite;
@@ -89,4 +91,12 @@ protected:
 private:
 	// Record when this object is marked for removal from the game.
 	bool shouldBeRemoved = false;
+
+	// The masks of the sprite, cached so that they do not have to be looked up
+	// every time. They are looked up again if the sprite or scale changes, or
+	// if the mask manager's masks change.
+	mutable const std::vector<Mask> *masks = nullptr;
+	mutable const Sprite *maskSprite = nullptr;
+	mutable Point maskScale;
+	mutable unsigned maskGeneration = 0;
 };
@@ -0,0 +1,156 @@
+/* CacheFolder.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "CacheFolder.h"
+
+#include "Files.h"
+#include "Logger.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+using namespace std;
+
+namespace {
+	const string EXTENSION = ".bin";
+
+	// Get the name of the cached file for the given result name.
+	string CacheName(const string &name)
+	{
+		static const char HEX[] = "0123456789abcdef";
+		uint64_t hash = std::hash<string>()(name);
+		string fileName;
+		for(int shift = 60; shift >= 0; shift -= 4)
+			fileName += HEX[(hash >> shift) & 0xF];
+		return fileName + EXTENSION;
+	}
+}
+
+
+
+// Get a key that changes whenever the file at the given path changes. It
+// holds the path, size, modification time and a hash of the contents of
+// the file. If the file has no size or modification time of its own, as
+// for files inside zipped plugins, the key is empty.
+string CacheFolder::FileKey(const filesystem::path &path)
+{
+	error_code error;
+	uintmax_t size = filesystem::file_size(path, error);
+	filesystem::file_time_type time = filesystem::last_write_time(path, error);
+	if(error)
+		return {};
+
+	// The hash of the contents catches files that are changed without
+	// changing their size or time.
+	MappedFile source(path);
+	return path.string() + '\n' + to_string(size) + '\n' + to_string(time.time_since_epoch().count())
+		+ '\n' + to_string(std::hash<string_view>()(source.View()));
+}
+
+
+
+// Get a key that changes whenever any of the given files changes. If any
+// of them has no key of its own, or no files are given, the key is empty.
+string CacheFolder::FileKey(const vector<filesystem::path> &paths)
+{
+	string key;
+	for(const filesystem::path &path : paths)
+	{
+		string fileKey = FileKey(path);
+		if(fileKey.empty())
+			return {};
+		key += fileKey + '\n';
+	}
+	return key;
+}
+
+
+
+// Keep the cached files in the given directory. If it cannot be created,
+// nothing is cached.
+CacheFolder::CacheFolder(const filesystem::path &directory)
+	: directory(directory)
+{
+	try {
+		Files::CreateFolder(directory);
+	}
+	catch(const runtime_error &)
+	{
+		Logger::Log("Unable to create the cache at \"" + directory.string() + "\".", Logger::Level::WARNING);
+		this->directory.clear();
+	}
+}
+
+
+
+// Check whether results can be cached at all.
+bool CacheFolder::IsEnabled() const
+{
+	return !directory.empty();
+}
+
+
+
+// Get the path of the file that caches the result with the given name,
+// and mark that file as used.
+filesystem::path CacheFolder::Use(const string &name)
+{
+	string fileName = CacheName(name);
+	{
+		lock_guard<mutex> lock(usedMutex);
+		used.insert(fileName);
+	}
+	return directory / fileName;
+}
+
+
+
+// Replace the contents of the given cached file. Nothing ever sees a
+// partially written file.
+void CacheFolder::Write(const filesystem::path &path, const string &data) const
+{
+	filesystem::path temporary = path;
+	temporary += ".tmp";
+	{
+		ofstream out(temporary, ios::binary | ios::trunc);
+		out.write(data.data(), data.size());
+		if(!out)
+			return;
+	}
+	error_code error;
+	filesystem::rename(temporary, path, error);
+}
+
+
+
+// Delete any cached files that were not used since this folder was created.
+void CacheFolder::RemoveUnused() const
+{
+	if(directory.empty())
+		return;
+
+	lock_guard<mutex> lock(usedMutex);
+	for(const filesystem::path &path : Files::List(directory))
+		if(!used.contains(path.filename().string()))
+		{
+			error_code error;
+			filesystem::remove(path, error);
+		}
+}
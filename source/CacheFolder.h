@@ -0,0 +1,67 @@
+/* CacheFolder.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+
+
+// A CacheFolder holds files that store the results of slow computations on
+// source files, such as parsing data files or tracing collision masks, so
+// that they do not have to be redone if the source files have not changed.
+// Each cached result is kept in a file of its own, and files that were not
+// used since the CacheFolder was created can be removed afterwards. Cached
+// files can be used from several threads at once.
+class CacheFolder {
+public:
+	// Get a key that changes whenever the file at the given path changes. It
+	// holds the path, size, modification time and a hash of the contents of
+	// the file. If the file has no size or modification time of its own, as
+	// for files inside zipped plugins, the key is empty.
+	static std::string FileKey(const std::filesystem::path &path);
+	// Get a key that changes whenever any of the given files changes. If any
+	// of them has no key of its own, or no files are given, the key is empty.
+	static std::string FileKey(const std::vector<std::filesystem::path> &paths);
+
+
+public:
+	// Keep the cached files in the given directory. If it cannot be created,
+	// nothing is cached.
+	explicit CacheFolder(const std::filesystem::path &directory);
+
+	// Check whether results can be cached at all.
+	bool IsEnabled() const;
+	// Get the path of the file that caches the result with the given name,
+	// and mark that file as used.
+	std::filesystem::path Use(const std::string &name);
+	// Replace the contents of the given cached file. Nothing ever sees a
+	// partially written file.
+	void Write(const std::filesystem::path &path, const std::string &data) const;
+	// Delete any cached files that were not used since this folder was created.
+	void RemoveUnused() const;
+
+
+private:
+	std::filesystem::path directory;
+
+	// The names of the cached files that were used.
+	std::set<std::string> used;
+	mutable std::mutex usedMutex;
+};
@@ -25,6 +25,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Ship.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <numeric>
 #include <set>
@@ -38,7 +39,7 @@ namespace {
 	// Velocity used for any projectiles with v > MAX_VELOCITY
 	constexpr int USED_MAX_VELOCITY = MAX_VELOCITY - 1;
 	// Warn the user only once about too-large projectile velocities.
-	bool warned = false;
+	atomic<bool> warned = false;
 
 	thread_local vector<bool> seen;
 }
@@ -131,6 +132,12 @@ void CollisionSet::Finish()
 		sorted[counts[index]++] = entry;
 	}
 	// Now, counts[index] is where a certain bin begins.
+
+	// Bring every object's animation frame and cached masks up to date, so that
+	// queries (which look up the mask for the current frame) only read from the
+	// objects and may safely be made from several threads at once.
+	for(const Body *body : all)
+		body->GetMask(step);
 }
 
 
@@ -202,11 +209,10 @@ void CollisionSet::Line(const Point &from, const Point &to, vector<Collision> &l
 	if(pVelocity.Length() > MAX_VELOCITY)
 	{
 		// Cap projectile velocity to prevent integer overflows.
-		if(!warned)
+		if(!warned.exchange(true))
 		{
 			Logger::Log("A projectile exceeded the maximum allowed velocity (" + to_string(MAX_VELOCITY) + ").",
 				Logger::Level::WARNING);
-			warned = true;
 		}
 		Point newEnd = from + pVelocity.Unit() * USED_MAX_VELOCITY;
 
@@ -42,6 +42,7 @@ public:
 	// Add an object to the set.
 	void Add(Body &body);
 	// Finish adding objects (and organize them into the final lookup table).
+	// Once finished, the set may be queried from several threads at once.
 	void Finish();
 
 	// Get all possible collisions for the given projectile. Collisions are not necessarily
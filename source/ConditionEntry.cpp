@@ -15,9 +15,13 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "ConditionEntry.h"
 
+#include "ConditionsStore.h"
+
 
 using namespace std;
 
+atomic<uint64_t> ConditionEntry::layoutGeneration = 1;
+
 
 
 ConditionEntry::ConditionEntry(const string &name)
@@ -129,6 +133,9 @@ void ConditionEntry::ProvidePrefixed(function<int64_t(const ConditionEntry &)> g
 {
 	this->getFunction = std::move(getFunction);
 	this->providingEntry = this;
+	++layoutGeneration;
+	if(store)
+		++store->providerRevision;
 }
 
 
@@ -146,6 +153,9 @@ void ConditionEntry::ProvideNamed(function<int64_t(const ConditionEntry &)> getF
 {
 	this->getFunction = std::move(getFunction);
 	this->providingEntry = nullptr;
+	++layoutGeneration;
+	if(store)
+		++store->providerRevision;
 }
 
 
@@ -161,6 +171,7 @@ void ConditionEntry::ProvideNamed(function<int64_t(const ConditionEntry &)> getF
 
 void ConditionEntry::NotifyUpdate(uint64_t value)
 {
-	// Subscribing is not implemented yet.
-	return;
+	// Subscribing is not implemented yet, but the store keeps track of which of its conditions changed.
+	if(store)
+		store->changed.insert(name);
 }
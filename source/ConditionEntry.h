@@ -15,6 +15,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -82,4 +83,10 @@ private:
 
 	/// conditionEntry that provides the prefixed condition, or nullptr if this is a regular or named condition.
 	const ConditionEntry *providingEntry = nullptr;
+
+	/// The store that holds this entry, which records the changes to it, or nullptr for temporary accessors.
+	ConditionsStore *store = nullptr;
+	/// Incremented whenever entries are added to or removed from a ConditionsStore, or providers are registered.
+	/// Handles to conditions compare against this to know when they need to look up their entry again.
+	static std::atomic<uint64_t> layoutGeneration;
 };
@@ -23,7 +23,6 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <algorithm>
 #include <cmath>
 #include <limits>
-#include <numeric>
 #include <set>
 #include <utility>
 
@@ -31,34 +30,8 @@ using namespace std;
 
 namespace
 {
-	typedef int64_t (*BinFun)(int64_t, int64_t);
-	BinFun Op(ConditionSet::ExpressionOp op)
-	{
-		// This map defines functions that each "operator" should be mapped to.
-		// In each function "a" is the condition's current value and "b" is the
-		// integer value given as the other argument of the operator.
-		// Test operators return 0 (false) or 1 (true).
-		// "Apply" operators return the value that the condition should have
-		// after applying the expression.
-		static const map<ConditionSet::ExpressionOp, BinFun> opMap = {
-			{ConditionSet::ExpressionOp::EQ, [](int64_t a, int64_t b) -> int64_t { return a == b; }},
-			{ConditionSet::ExpressionOp::NE, [](int64_t a, int64_t b) -> int64_t { return a != b; }},
-			{ConditionSet::ExpressionOp::LT, [](int64_t a, int64_t b) -> int64_t { return a < b; }},
-			{ConditionSet::ExpressionOp::GT, [](int64_t a, int64_t b) -> int64_t { return a > b; }},
-			{ConditionSet::ExpressionOp::LE, [](int64_t a, int64_t b) -> int64_t { return a <= b; }},
-			{ConditionSet::ExpressionOp::GE, [](int64_t a, int64_t b) -> int64_t { return a >= b; }},
-			{ConditionSet::ExpressionOp::MOD, [](int64_t a, int64_t b) { return b ? a % b : a; }},
-			{ConditionSet::ExpressionOp::MUL, [](int64_t a, int64_t b) { return a * b; }},
-			{ConditionSet::ExpressionOp::ADD, [](int64_t a, int64_t b) { return a + b; }},
-			{ConditionSet::ExpressionOp::SUB, [](int64_t a, int64_t b) { return a - b; }},
-			{ConditionSet::ExpressionOp::DIV, [](int64_t a, int64_t b) { return b ? a / b : numeric_limits<int64_t>::max(); }},
-			{ConditionSet::ExpressionOp::MAX, [](int64_t a, int64_t b) { return max(a, b); }},
-			{ConditionSet::ExpressionOp::MIN, [](int64_t a, int64_t b) { return min(a, b); }},
-		};
-
-		auto it = opMap.find(op);
-		return (it != opMap.end() ? it->second : nullptr);
-	}
+	// Most expressions need only a few values on the stack while they are evaluated.
+	constexpr size_t SMALL_STACK_SIZE = 16;
 
 	// Expressions that define how operators should be parsed and written
 	constexpr uint64_t ONE = 1;
@@ -166,6 +139,7 @@ ConditionSet::ConditionSet(int64_t newLiteral, const ConditionsStore *conditions
 	expressionOperator = ExpressionOp::LIT;
 	literal = newLiteral;
 	this->conditions = conditions;
+	Compile();
 }
 
 
@@ -185,8 +159,11 @@ ConditionSet &ConditionSet::operator=(const ConditionSet &&other) noexcept
 	expressionOperator = other.expressionOperator;
 	literal = other.literal;
 	conditionName = std::move(other.conditionName);
+	handle = other.handle;
 	children = std::move(other.children);
 	conditions = other.conditions;
+	program = std::move(other.program);
+	stackSize = other.stackSize;
 
 	return *this;
 }
@@ -208,8 +185,11 @@ ConditionSet &ConditionSet::operator=(const ConditionSet &other)
 	expressionOperator = other.expressionOperator;
 	literal = other.literal;
 	conditionName = other.conditionName;
+	handle = other.handle;
 	children = other.children;
 	conditions = other.conditions;
+	program = other.program;
+	stackSize = other.stackSize;
 
 	return *this;
 }
@@ -226,6 +206,7 @@ void ConditionSet::Load(const DataNode &node, const ConditionsStore *conditions)
 	// The top-node is always an 'and' node, without the keyword.
 	expressionOperator = ExpressionOp::AND;
 	ParseChildren(node);
+	Compile();
 }
 
 
@@ -350,6 +331,7 @@ void ConditionSet::MakeNever()
 	children.clear();
 	expressionOperator = ExpressionOp::LIT;
 	literal = 0;
+	Compile();
 }
 
 
@@ -384,59 +366,17 @@ bool ConditionSet::Test() const
 
 int64_t ConditionSet::Evaluate() const
 {
-	switch(expressionOperator)
-	{
-		case ExpressionOp::VAR:
-		{
-			if(!conditions)
-				throw runtime_error("Unable to Evaluate ExpressionOp::VAR with condition name \"" + conditionName
-					+ "\" in ConditionSet without a pointer to a ConditionsStore!");
-			return conditions->Get(conditionName);
-		}
-		case ExpressionOp::LIT:
-			return literal;
-		case ExpressionOp::AND:
-		{
-			// An empty AND section returns true.
-			if(children.empty())
-				return 1;
+	// An expression that was never compiled is empty, and empty expressions are true.
+	if(program.empty())
+		return 1;
 
-			int64_t result = 0;
-			for(const ConditionSet &child : children)
-			{
-				int64_t childResult = child.Evaluate();
-				if(!childResult)
-					return 0;
-				// Assign the first non-zero result to the result variable.
-				if(!result)
-					result = childResult;
-			}
-			return result;
-		}
-		case ExpressionOp::OR:
-			for(const ConditionSet &child : children)
-			{
-				int64_t childResult = child.Evaluate();
-				// Return the first non-zero result.
-				if(childResult)
-					return childResult;
-			}
-			return 0;
-		default:
-			break;
+	if(stackSize <= SMALL_STACK_SIZE)
+	{
+		int64_t stack[SMALL_STACK_SIZE];
+		return Run(program.data(), program.data() + program.size(), stack);
 	}
-
-	// If we have an accumulator function and children, then let's use the accumulator on the children.
-	// MAX and MIN are also handled by the accumulator.
-	BinFun accumulatorOp = Op(expressionOperator);
-	if(accumulatorOp != nullptr && !children.empty())
-		return accumulate(next(children.begin()), children.end(), children[0].Evaluate(),
-			[&accumulatorOp](int64_t accumulated, const ConditionSet &b) -> int64_t {
-				return accumulatorOp(accumulated, b.Evaluate());
-		});
-
-	// If we don't have an accumulator function, or no children, then return the default value.
-	return 0;
+	vector<int64_t> stack(stackSize);
+	return Run(program.data(), program.data() + program.size(), stack.data());
 }
 
 
@@ -507,8 +447,7 @@ bool ConditionSet::ParseFromStart(const DataNode &node)
 			return FailParse(node, "Has keyword requires a single condition");
 
 		// Convert has keyword directly to the variable.
-		expressionOperator = ExpressionOp::VAR;
-		conditionName = node.Token(1);
+		SetVariable(node.Token(1));
 		return true;
 	}
 	if(key == "not")
@@ -519,22 +458,40 @@ bool ConditionSet::ParseFromStart(const DataNode &node)
 		// Create `conditionName == 0` expression.
 		expressionOperator = ExpressionOp::EQ;
 		children.emplace_back(conditions);
-		children.back().expressionOperator = ExpressionOp::VAR;
-		children.back().conditionName = node.Token(1);
+		children.back().SetVariable(node.Token(1));
 		children.emplace_back(0, conditions);
 		return true;
 	}
 
 	int tokenNr = 0;
-	if(!ParseNode(node, tokenNr))
+	if(!ParseTokens(node, tokenNr))
 		return false;
 
-	return Optimize(node);
+	return OptimizeTree(node);
 }
 
 
 
 bool ConditionSet::ParseNode(const DataNode &node, int &tokenNr)
+{
+	const bool result = ParseTokens(node, tokenNr);
+	Compile();
+	return result;
+}
+
+
+
+/// Optimize this node, this optimization also removes intermediate sections that were used for tracking brackets.
+bool ConditionSet::Optimize(const DataNode &node)
+{
+	const bool result = OptimizeTree(node);
+	Compile();
+	return result;
+}
+
+
+
+bool ConditionSet::ParseTokens(const DataNode &node, int &tokenNr)
 {
 	if(!conditions)
 		throw runtime_error("Unable to ParseNode(indexed) for a ConditionSet without a pointer to a ConditionsStore!");
@@ -555,13 +512,12 @@ bool ConditionSet::ParseNode(const DataNode &node, int &tokenNr)
 
 
 
-/// Optimize this node, this optimization also removes intermediate sections that were used for tracking brackets.
-bool ConditionSet::Optimize(const DataNode &node)
+bool ConditionSet::OptimizeTree(const DataNode &node)
 {
 	bool returnValue = true;
 	// First optimize all the child nodes below.
 	for(ConditionSet &child : children)
-		returnValue &= child.Optimize(node);
+		returnValue &= child.OptimizeTree(node);
 
 	switch(expressionOperator)
 	{
@@ -677,7 +633,7 @@ bool ConditionSet::ParseMini(const DataNode &node, int &tokenNr)
 		++tokenNr;
 		break;
 	case ExpressionOp::VAR:
-		conditionName = node.Token(tokenNr);
+		SetVariable(node.Token(tokenNr));
 		++tokenNr;
 		break;
 	default:
@@ -854,6 +810,279 @@ bool ConditionSet::PushDownLast(const DataNode &node)
 
 
 
+void ConditionSet::Compile()
+{
+	program.clear();
+	CompileInto(program);
+	program.shrink_to_fit();
+	stackSize = StackSize(program.data(), program.data() + program.size());
+}
+
+
+
+void ConditionSet::CompileInto(vector<Instruction> &code) const
+{
+	const size_t start = code.size();
+	// The jumps that skip to the end of this expression.
+	vector<size_t> jumps;
+	// Arithmetic and comparison operators are applied from left to right over the sub-expressions.
+	auto compileOperator = [this, &code](Code binary) -> void {
+		children[0].CompileInto(code);
+		for(size_t i = 1; i < children.size(); ++i)
+		{
+			children[i].CompileInto(code);
+			code.push_back({binary});
+		}
+	};
+
+	switch(expressionOperator)
+	{
+		case ExpressionOp::LIT:
+			code.push_back({Code::LIT, literal});
+			return;
+		case ExpressionOp::VAR:
+			code.push_back({Code::VAR, 0, handle});
+			return;
+		case ExpressionOp::INVALID:
+			code.push_back({Code::LIT, 0});
+			return;
+		case ExpressionOp::AND:
+			// An empty AND section is true. Otherwise, the result is zero as soon as one of the
+			// sub-expressions is zero, and the value of the first sub-expression if none are.
+			if(children.empty())
+			{
+				code.push_back({Code::LIT, 1});
+				return;
+			}
+			children[0].CompileInto(code);
+			for(size_t i = 1; i < children.size(); ++i)
+			{
+				if(i == 1)
+				{
+					jumps.push_back(code.size());
+					code.push_back({Code::JUMP_IF_ZERO});
+				}
+				children[i].CompileInto(code);
+				jumps.push_back(code.size());
+				code.push_back({Code::AND_NEXT});
+			}
+			break;
+		case ExpressionOp::OR:
+			// The result is the first sub-expression that is not zero, or zero if all of them are.
+			if(children.empty())
+			{
+				code.push_back({Code::LIT, 0});
+				return;
+			}
+			for(size_t i = 0; i + 1 < children.size(); ++i)
+			{
+				children[i].CompileInto(code);
+				jumps.push_back(code.size());
+				code.push_back({Code::JUMP_IF_NONZERO});
+				code.push_back({Code::POP});
+			}
+			children.back().CompileInto(code);
+			break;
+		default:
+			// Operators without sub-expressions have a value of zero.
+			if(children.empty())
+			{
+				code.push_back({Code::LIT, 0});
+				return;
+			}
+			switch(expressionOperator)
+			{
+				case ExpressionOp::ADD:
+					compileOperator(Code::ADD);
+					break;
+				case ExpressionOp::SUB:
+					compileOperator(Code::SUB);
+					break;
+				case ExpressionOp::MUL:
+					compileOperator(Code::MUL);
+					break;
+				case ExpressionOp::DIV:
+					compileOperator(Code::DIV);
+					break;
+				case ExpressionOp::MOD:
+					compileOperator(Code::MOD);
+					break;
+				case ExpressionOp::MIN:
+					compileOperator(Code::MIN);
+					break;
+				case ExpressionOp::MAX:
+					compileOperator(Code::MAX);
+					break;
+				case ExpressionOp::EQ:
+					compileOperator(Code::EQ);
+					break;
+				case ExpressionOp::NE:
+					compileOperator(Code::NE);
+					break;
+				case ExpressionOp::LE:
+					compileOperator(Code::LE);
+					break;
+				case ExpressionOp::GE:
+					compileOperator(Code::GE);
+					break;
+				case ExpressionOp::LT:
+					compileOperator(Code::LT);
+					break;
+				case ExpressionOp::GT:
+					compileOperator(Code::GT);
+					break;
+				default:
+					code.push_back({Code::LIT, 0});
+					return;
+			}
+			break;
+	}
+
+	for(size_t jump : jumps)
+		code[jump].value = code.size() - jump;
+
+	// An expression that does not read any conditions always has the same value.
+	const Instruction *begin = code.data() + start;
+	const Instruction *end = code.data() + code.size();
+	const auto readsCondition = [](const Instruction &instruction) { return instruction.code == Code::VAR; };
+	if(end - begin > 1 && none_of(begin, end, readsCondition))
+	{
+		vector<int64_t> stack(StackSize(begin, end));
+		const int64_t value = Run(begin, end, stack.data());
+		code.resize(start);
+		code.push_back({Code::LIT, value});
+	}
+}
+
+
+
+int64_t ConditionSet::Run(const Instruction *it, const Instruction *end, int64_t *stack) const
+{
+	// The number of values on the stack. Operators combine the top value with the one below it.
+	size_t size = 0;
+	while(it != end)
+	{
+		switch(it->code)
+		{
+			case Code::LIT:
+				stack[size++] = it->value;
+				break;
+			case Code::VAR:
+				stack[size++] = conditions->Get(*it->handle);
+				break;
+			case Code::ADD:
+				--size;
+				stack[size - 1] += stack[size];
+				break;
+			case Code::SUB:
+				--size;
+				stack[size - 1] -= stack[size];
+				break;
+			case Code::MUL:
+				--size;
+				stack[size - 1] *= stack[size];
+				break;
+			case Code::DIV:
+				--size;
+				stack[size - 1] = stack[size] ? stack[size - 1] / stack[size] : numeric_limits<int64_t>::max();
+				break;
+			case Code::MOD:
+				--size;
+				if(stack[size])
+					stack[size - 1] %= stack[size];
+				break;
+			case Code::MIN:
+				--size;
+				stack[size - 1] = min(stack[size - 1], stack[size]);
+				break;
+			case Code::MAX:
+				--size;
+				stack[size - 1] = max(stack[size - 1], stack[size]);
+				break;
+			case Code::EQ:
+				--size;
+				stack[size - 1] = stack[size - 1] == stack[size];
+				break;
+			case Code::NE:
+				--size;
+				stack[size - 1] = stack[size - 1] != stack[size];
+				break;
+			case Code::LE:
+				--size;
+				stack[size - 1] = stack[size - 1] <= stack[size];
+				break;
+			case Code::GE:
+				--size;
+				stack[size - 1] = stack[size - 1] >= stack[size];
+				break;
+			case Code::LT:
+				--size;
+				stack[size - 1] = stack[size - 1] < stack[size];
+				break;
+			case Code::GT:
+				--size;
+				stack[size - 1] = stack[size - 1] > stack[size];
+				break;
+			case Code::JUMP_IF_ZERO:
+				if(!stack[size - 1])
+				{
+					it += it->value;
+					continue;
+				}
+				break;
+			case Code::JUMP_IF_NONZERO:
+				if(stack[size - 1])
+				{
+					it += it->value;
+					continue;
+				}
+				break;
+			case Code::AND_NEXT:
+				--size;
+				if(!stack[size])
+				{
+					stack[size - 1] = 0;
+					it += it->value;
+					continue;
+				}
+				break;
+			case Code::POP:
+				--size;
+				break;
+		}
+		++it;
+	}
+	return stack[0];
+}
+
+
+
+size_t ConditionSet::StackSize(const Instruction *it, const Instruction *end)
+{
+	// Jumps only skip ahead, so the stack is never larger than when running every instruction in order.
+	size_t size = 0;
+	size_t maxSize = 0;
+	for( ; it != end; ++it)
+	{
+		if(it->code == Code::LIT || it->code == Code::VAR)
+			maxSize = max(maxSize, ++size);
+		else if(it->code != Code::JUMP_IF_ZERO && it->code != Code::JUMP_IF_NONZERO)
+			--size;
+	}
+	return maxSize;
+}
+
+
+
+void ConditionSet::SetVariable(const string &name)
+{
+	expressionOperator = ExpressionOp::VAR;
+	conditionName = name;
+	handle = conditions->GetHandle(name);
+}
+
+
+
 bool ConditionSet::FailParse()
 {
 	expressionOperator = ExpressionOp::INVALID;
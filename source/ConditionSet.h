@@ -15,13 +15,14 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include "ConditionsStore.h"
+
 #include <cstdint>
 #include <map>
 #include <set>
 #include <string>
 #include <vector>
 
-class ConditionsStore;
 class DataNode;
 class DataWriter;
 
@@ -115,10 +116,50 @@ public:
 	std::set<std::string> RelevantConditions() const;
 
 
+private:
+	/// The instructions that expressions are compiled into. A compiled expression is a flat sequence in postfix order,
+	/// which is evaluated with a stack instead of by recursing through the sub-expressions.
+	enum class Code : uint8_t {
+		LIT, ///< Push the literal value.
+		VAR, ///< Push the value of the condition.
+		// Pop two values and push the result of the operator.
+		ADD, SUB, MUL, DIV, MOD, MIN, MAX, EQ, NE, LE, GE, LT, GT,
+		JUMP_IF_ZERO, ///< Skip ahead by the value if the top of the stack is zero.
+		JUMP_IF_NONZERO, ///< Skip ahead by the value if the top of the stack is not zero.
+		AND_NEXT, ///< Pop a value. If it is zero, replace the top of the stack by zero and skip ahead by the value.
+		POP ///< Pop a value.
+	};
+
+	class Instruction {
+	public:
+		Code code;
+		/// The literal to push, or the number of instructions to skip.
+		int64_t value = 0;
+		/// The condition to push.
+		const ConditionsStore::Handle *handle = nullptr;
+	};
+
+
 private:
 	/// Parse a node completely into this expression; all tokens on the line and all children if there are any.
 	bool ParseFromStart(const DataNode &node);
 
+	/// Parse the tokens of a node into this expression, without compiling it.
+	bool ParseTokens(const DataNode &node, int &tokenNr);
+
+	/// Optimize this expression and its sub-expressions, without compiling it.
+	bool OptimizeTree(const DataNode &node);
+
+	/// Compile this expression into the instructions that Evaluate() runs.
+	void Compile();
+	/// Append the instructions for this expression to the given code. Sub-expressions without
+	/// any condition variables are replaced by their value.
+	void CompileInto(std::vector<Instruction> &code) const;
+	/// Run the given instructions, using the given stack, and return the value they result in.
+	int64_t Run(const Instruction *it, const Instruction *end, int64_t *stack) const;
+	/// Get the size of the stack that the given instructions need.
+	static size_t StackSize(const Instruction *it, const Instruction *end);
+
 	/// Parse the children under 'and'-nodes, 'or'-nodes, or the toplevel-node (which acts as and-node). The
 	/// expression-operator should already have been set before calling this function.
 	bool ParseChildren(const DataNode &node);
@@ -161,6 +202,9 @@ private:
 	/// @param node Node on which to report the failures (using node.PrintTrace()).
 	bool PushDownLast(const DataNode &node);
 
+	/// Make this expression a terminal that reads the condition with the given name.
+	void SetVariable(const std::string &name);
+
 	/// Handles a failure in parsing of lower-level nodes, for higher-level nodes;
 	/// - Clears the sub-expressions and sets the operator to INVALID.
 	bool FailParse();
@@ -188,9 +232,16 @@ private:
 	int64_t literal = 0;
 	/// Condition variable that is used in this expression, if this is a condition variable.
 	std::string conditionName;
+	/// Handle to the condition variable in the ConditionsStore, so that it does not need to be searched by name.
+	const ConditionsStore::Handle *handle = nullptr;
 	/// Nested sets of conditions to be tested.
 	std::vector<ConditionSet> children;
 
+	/// The compiled form of this expression, and the stack size that it needs. Only top-level expressions
+	/// are compiled; an expression that was never compiled is empty.
+	std::vector<Instruction> program;
+	size_t stackSize = 0;
+
 	// Let the assignment class call internal functions and parsers.
 	friend class ConditionAssignments;
 };
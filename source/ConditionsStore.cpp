@@ -26,6 +26,20 @@ using namespace std;
 
 
 
+ConditionsStore::Handle::Handle(const string &name)
+	: name(name)
+{
+}
+
+
+
+const string &ConditionsStore::Handle::Name() const
+{
+	return name;
+}
+
+
+
 // Constructor with loading primary conditions from datanode.
 ConditionsStore::ConditionsStore(const DataNode &node)
 {
@@ -52,6 +66,29 @@ ConditionsStore::ConditionsStore(const map<string, int64_t> &initialConditions)
 
 
 
+ConditionsStore &ConditionsStore::operator=(ConditionsStore &&other)
+{
+	if(this == &other)
+		return *this;
+
+	// The entries that the handles point to are being replaced, so they need to look them up again.
+	storage = std::move(other.storage);
+	++ConditionEntry::layoutGeneration;
+
+	// Every condition may have a different value now, including the derived ones.
+	changed.clear();
+	other.changed.clear();
+	for(auto &it : storage)
+	{
+		it.second.store = this;
+		changed.insert(changed.end(), it.first);
+	}
+	++providerRevision;
+	return *this;
+}
+
+
+
 void ConditionsStore::Load(const DataNode &node)
 {
 	for(const DataNode &child : node)
@@ -113,6 +150,42 @@ int64_t ConditionsStore::Get(const string &name) const
 
 
 
+int64_t ConditionsStore::Get(const Handle &handle) const
+{
+	// Look up the entry again if the layout of any store changed since the last time.
+	const uint64_t generation = ConditionEntry::layoutGeneration.load(memory_order_acquire);
+	if(handle.generation.load(memory_order_acquire) != generation)
+	{
+		const ConditionEntry *ce = GetEntry(handle.name);
+		const bool isExact = ce && ce->name == handle.name;
+		handle.entry.store(isExact ? ce : nullptr, memory_order_relaxed);
+		handle.provider.store(isExact ? nullptr : ce, memory_order_relaxed);
+		handle.generation.store(generation, memory_order_release);
+	}
+
+	const ConditionEntry *ce = handle.entry.load(memory_order_relaxed);
+	if(ce)
+		return *ce;
+
+	// Prefixed providers without an exactly matching entry are accessed the same way as in Get(name).
+	const ConditionEntry *provider = handle.provider.load(memory_order_relaxed);
+	if(!provider)
+		return 0;
+	ConditionEntry ceAccessor(handle.name);
+	ceAccessor.providingEntry = provider;
+	return ceAccessor;
+}
+
+
+
+const ConditionsStore::Handle *ConditionsStore::GetHandle(const string &name) const
+{
+	lock_guard<mutex> lock(handleMutex);
+	return &handles.try_emplace(name, name).first->second;
+}
+
+
+
 void ConditionsStore::Add(const string &name, int64_t value)
 {
 	(*this)[name] += value;
@@ -140,6 +213,8 @@ ConditionEntry &ConditionsStore::operator[](const string &name)
 	// Create the entry (name is used as key, and as ConditionEntry constructor argument.
 	auto emp = storage.emplace(make_pair(name, name));
 	it = emp.first;
+	it->second.store = this;
+	++ConditionEntry::layoutGeneration;
 
 	// If a relevant prefix provider is found, then provision this entry with the provider.
 	if(ceprov != nullptr)
@@ -151,6 +226,30 @@ ConditionEntry &ConditionsStore::operator[](const string &name)
 
 
 
+bool ConditionsStore::IsDerived(const string &name) const
+{
+	const ConditionEntry *ce = GetEntry(name);
+	return ce && (ce->getFunction || ce->providingEntry);
+}
+
+
+
+set<string> ConditionsStore::TakeChanges()
+{
+	set<string> result;
+	result.swap(changed);
+	return result;
+}
+
+
+
+uint64_t ConditionsStore::ProviderRevision() const
+{
+	return providerRevision;
+}
+
+
+
 int64_t ConditionsStore::PrimariesSize() const
 {
 	int64_t result = 0;
@@ -17,10 +17,14 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "ConditionEntry.h"
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <initializer_list>
 #include <map>
+#include <mutex>
+#include <set>
+#include <string>
 
 class DataNode;
 class DataWriter;
@@ -38,6 +42,29 @@ class DataWriter;
 // data types than int64_t (for example double, float or even complex
 // formulae).
 class ConditionsStore {
+	friend ConditionEntry;
+public:
+	/// A condition name that was resolved against a store. Reading a condition through its handle only searches
+	/// the store when conditions were added or removed, or providers were registered, since the previous read.
+	class Handle {
+	public:
+		explicit Handle(const std::string &name);
+
+		const std::string &Name() const;
+
+
+	private:
+		friend ConditionsStore;
+
+		std::string name;
+		/// The entry with exactly this name, if there is one, or otherwise the prefixed provider of this name.
+		mutable std::atomic<const ConditionEntry *> entry = nullptr;
+		mutable std::atomic<const ConditionEntry *> provider = nullptr;
+		/// The layout generation that the entries above were looked up in, or 0 if they were never looked up.
+		mutable std::atomic<uint64_t> generation = 0;
+	};
+
+
 public:
 	// Constructors to initialize this class.
 	ConditionsStore() = default;
@@ -48,7 +75,8 @@ public:
 	ConditionsStore(const ConditionsStore &) = delete;
 	ConditionsStore &operator=(const ConditionsStore &) = delete;
 	ConditionsStore(ConditionsStore &&) = delete;
-	ConditionsStore &operator=(ConditionsStore &&) = default;
+	// Handles remain valid when the content of the store is replaced.
+	ConditionsStore &operator=(ConditionsStore &&other);
 
 	// Serialization support for this class.
 	void Load(const DataNode &node);
@@ -56,6 +84,11 @@ public:
 
 	/// Retrieve a "condition" flag from this store (directly or from a connected provider).
 	int64_t Get(const std::string &name) const;
+	/// Retrieve a condition through a handle from this store, without searching for it by name.
+	int64_t Get(const Handle &handle) const;
+	/// Get a handle for the given condition name, which remains valid for as long as this store exists.
+	/// This is meant to be done once for each condition that is read repeatedly, e.g. while loading data.
+	const Handle *GetHandle(const std::string &name) const;
 
 	/// Adds a value to the given condition. Can (silently) fail to apply when the condition is a readonly derived
 	/// condition, or when a readwrite derived condition doesn't accept the new value.
@@ -67,6 +100,15 @@ public:
 	/// Direct access to a specific condition (using the ConditionEntry as proxy).
 	ConditionEntry &operator[](const std::string &name);
 
+	/// Check if the given condition is derived from other data by a provider, instead of being stored here.
+	/// Changes to derived conditions are only recorded when they are set through this store.
+	bool IsDerived(const std::string &name) const;
+	/// Get the names of the conditions that were set since the previous call, and start recording changes anew.
+	std::set<std::string> TakeChanges();
+	/// Count how often derived condition providers were registered in this store, or the store was replaced.
+	/// Whenever this changes, the values of conditions may have changed without being recorded.
+	uint64_t ProviderRevision() const;
+
 	// Helper for testing; check how many primary conditions are registered.
 	int64_t PrimariesSize() const;
 
@@ -82,4 +124,10 @@ private:
 private:
 	// Storage for both the primary conditions as well as the providers.
 	std::map<std::string, ConditionEntry> storage;
+	// The names of the conditions that were set since the changes were last taken.
+	std::set<std::string> changed;
+	uint64_t providerRevision = 0;
+	// The handles given out by this store. They can be requested while data is being loaded in parallel.
+	mutable std::map<std::string, Handle> handles;
+	mutable std::mutex handleMutex;
 };
@@ -0,0 +1,66 @@
+/* DataCache.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "DataCache.h"
+
+#include "DataFile.h"
+#include "MappedFile.h"
+
+#include <string>
+
+using namespace std;
+
+
+
+// Keep the cached files in the given directory. If it cannot be created,
+// files are always parsed.
+DataCache::DataCache(const filesystem::path &directory)
+	: folder(directory)
+{
+}
+
+
+
+// Load the data file at the given path, from the cache if possible.
+void DataCache::Load(const filesystem::path &path, DataFile &file)
+{
+	// Only regular files have a size and a modification time to check. Files in
+	// zipped plugins, for example, are always parsed.
+	string key = folder.IsEnabled() ? CacheFolder::FileKey(path) : string();
+	if(key.empty())
+	{
+		file.Load(path);
+		return;
+	}
+
+	filesystem::path cachePath = folder.Use(path.string());
+	{
+		MappedFile cached(cachePath);
+		if(file.LoadBinary(cached.View(), key))
+			return;
+	}
+
+	file.Load(path);
+	if(!file.HasWarnings())
+		folder.Write(cachePath, file.SaveBinary(key));
+}
+
+
+
+// Delete any cached files that were not used since this cache was created.
+void DataCache::RemoveUnused() const
+{
+	folder.RemoveUnused();
+}
@@ -0,0 +1,47 @@
+/* DataCache.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "CacheFolder.h"
+
+#include <filesystem>
+
+class DataFile;
+
+
+
+// A DataCache keeps the parsed nodes of data files on disk in a binary form,
+// so that files that have not changed since the last time they were loaded do
+// not have to be parsed again. Each file is cached separately, along with the
+// path, size, modification time and a hash of the contents of the file it was
+// parsed from; if any of those differ, the file is parsed again. Files that
+// cause any warnings while parsing are never cached, so that the warnings are
+// shown every time. Loading files can be done from several threads at once.
+class DataCache {
+public:
+	// Keep the cached files in the given directory. If it cannot be created,
+	// files are always parsed.
+	explicit DataCache(const std::filesystem::path &directory);
+
+	// Load the data file at the given path, from the cache if possible.
+	void Load(const std::filesystem::path &path, DataFile &file);
+	// Delete any cached files that were not used since this cache was created.
+	void RemoveUnused() const;
+
+
+private:
+	CacheFolder folder;
+};
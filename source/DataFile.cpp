@@ -15,11 +15,21 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "DataFile.h"
 
-#include "Files.h"
-#include "text/Utf8.h"
+#include "BinaryData.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstdint>
 
 using namespace std;
 
+namespace {
+	// The binary form of a file starts with this, followed by a version number
+	// that must be changed whenever the binary form changes.
+	const uint32_t BINARY_MAGIC = 0x43445345;
+	const uint32_t BINARY_VERSION = 1;
+}
+
 
 
 // Constructor, taking a file path (in UTF-8).
@@ -41,17 +51,15 @@ DataFile::DataFile(istream &in)
 // Load from a file path (in UTF-8).
 void DataFile::Load(const filesystem::path &path)
 {
-	string data = Files::Read(path);
+	// The file is parsed directly from the mapped memory, without copying it.
+	MappedFile file(path);
+	string_view data = file.View();
 	if(data.empty())
 		return;
 
-	// As a sentinel, make sure the file always ends in a newline.
-	if(data.back() != '\n')
-		data.push_back('\n');
-
 	// Note what file this node is in, so it will show up in error traces.
-	root.tokens.push_back("file");
-	root.tokens.push_back(path.string());
+	root.AddToken("file");
+	root.AddToken(path.string());
 
 	LoadData(data);
 }
@@ -71,17 +79,115 @@ void DataFile::Load(istream &in)
 		in.read(&*data.begin() + currentSize, BLOCK);
 		data.resize(currentSize + in.gcount());
 	}
-	// As a sentinel, make sure the file always ends in a newline.
-	if(data.empty() || data.back() != '\n')
-		data.push_back('\n');
 
 	LoadData(data);
 }
 
 
 
+// Save the nodes of this file in a compact binary form, which can be loaded
+// much faster than parsing the text again. The given key is stored with the
+// nodes, and must match when loading them.
+string DataFile::SaveBinary(const string &key) const
+{
+	BinaryWriter out;
+	out.Write(BINARY_MAGIC);
+	out.Write(BINARY_VERSION);
+	out.WriteText(key);
+
+	out.Write<uint64_t>(root.tokenCount);
+	for(const string &token : root.Tokens())
+		out.WriteText(token);
+
+	// The nodes are stored in the same order as in memory, so that each node is
+	// followed by its descendants. The tokens of all the nodes come after them.
+	static const vector<DataNode> NO_NODES;
+	static const vector<string> NO_TOKENS;
+	const vector<DataNode> &nodes = root.storage ? root.storage->nodes : NO_NODES;
+	const vector<string> &tokens = root.storage ? root.storage->tokens : NO_TOKENS;
+	out.Write<uint64_t>(nodes.size());
+	for(const DataNode &node : nodes)
+	{
+		out.Write<uint64_t>(node.lineNumber);
+		out.Write(node.tokenCount);
+		out.Write(node.descendants);
+	}
+	out.Write<uint64_t>(tokens.size());
+	for(const string &token : tokens)
+		out.WriteText(token);
+
+	return out.Data();
+}
+
+
+
+// Load nodes that were saved by SaveBinary() with the same key. If the data
+// is not valid, this returns false and leaves this file unchanged.
+bool DataFile::LoadBinary(string_view data, const string &key)
+{
+	BinaryReader in(data);
+	if(in.Read<uint32_t>() != BINARY_MAGIC || in.Read<uint32_t>() != BINARY_VERSION || in.ReadText() != key)
+		return false;
+
+	DataNode loaded;
+	uint64_t rootTokens = in.Read<uint64_t>();
+	if(!in.HasRoom(rootTokens, sizeof(uint64_t)))
+		return false;
+	for(uint64_t i = 0; i < rootTokens; ++i)
+		loaded.AddToken(string(in.ReadText()));
+
+	DataNode::Storage &storage = loaded.Own();
+	uint64_t nodeCount = in.Read<uint64_t>();
+	if(!in.HasRoom(nodeCount, sizeof(uint64_t) + 2 * sizeof(uint32_t)))
+		return false;
+	storage.nodes.reserve(nodeCount);
+	// Make sure that the descendants of each node lie within its parent's
+	// descendants, so that iterating over the nodes cannot run off the end.
+	vector<uint64_t> ends;
+	uint64_t tokenCount = 0;
+	for(uint64_t i = 0; i < nodeCount; ++i)
+	{
+		DataNode &node = storage.nodes.emplace_back();
+		node.lineNumber = in.Read<uint64_t>();
+		node.tokenIndex = tokenCount;
+		node.tokenCount = in.Read<uint32_t>();
+		node.descendants = in.Read<uint32_t>();
+		tokenCount += node.tokenCount;
+
+		while(!ends.empty() && ends.back() <= i)
+			ends.pop_back();
+		uint64_t end = i + 1 + node.descendants;
+		if(end > (ends.empty() ? nodeCount : ends.back()))
+			return false;
+		if(node.descendants)
+			ends.push_back(end);
+	}
+	if(in.Read<uint64_t>() != tokenCount || !in.HasRoom(tokenCount, sizeof(uint64_t)))
+		return false;
+	storage.tokens.reserve(tokenCount);
+	for(uint64_t i = 0; i < tokenCount; ++i)
+		storage.tokens.emplace_back(in.ReadText());
+	if(!in.IsValid() || !in.AtEnd())
+		return false;
+
+	loaded.Relink();
+	root = std::move(loaded);
+	hasWarnings = false;
+	return true;
+}
+
+
+
+// Check if any warnings were printed while parsing this file.
+bool DataFile::HasWarnings() const
+{
+	return hasWarnings;
+}
+
+
+
 // Get an iterator to the start of the list of nodes in this file.
-list<DataNode>::const_iterator DataFile::begin() const
+DataNode::ConstIterator DataFile::begin() const
 {
 	return root.begin();
 }
@@ -89,7 +195,7 @@ list<DataNode>::const_iterator DataFile::begin() const
 
 
 // Get an iterator to the end of the list of nodes in this file.
-list<DataNode>::const_iterator DataFile::end() const
+DataNode::ConstIterator DataFile::end() const
 {
 	return root.end();
 }
@@ -97,29 +203,50 @@ list<DataNode>::const_iterator DataFile::end() const
 
 
 // Parse the given text.
-void DataFile::LoadData(const string &data)
+void DataFile::LoadData(string_view data)
 {
+	// The nodes are added to the root's storage in the order they appear in the
+	// file, which is exactly the depth-first order that the storage needs.
+	DataNode::Storage &storage = root.Own();
+	vector<DataNode> &nodes = storage.nodes;
+	vector<string> &tokens = storage.tokens;
+	// Every node takes up at least one line, so this is enough room for all of them.
+	nodes.reserve(nodes.size() + count(data.begin(), data.end(), '\n') + 1);
+
 	// Keep track of the current stack of indentation levels and the most recent
 	// node at each level - that is, the node that will be the "parent" of any
 	// new node added at the next deeper indentation level.
-	vector<DataNode *> stack(1, &root);
-	vector<int> separatorStack(1, -1);
+	vector<size_t> stack;
+	vector<int> separatorStack;
+	// The tokens may move around until the whole file has been read, so any
+	// warnings must wait until then. Warnings about the root have no index.
+	vector<pair<size_t, string>> warnings;
+	const size_t ROOT = string::npos;
 	bool fileIsTabs = false;
 	bool fileIsSpaces = false;
 	size_t lineNumber = 0;
 
+	// All the characters that determine the structure of the file are ASCII, and
+	// in UTF-8 every byte of a multi-byte character has its high bit set, so the
+	// file can be scanned one byte at a time without decoding it: any byte with
+	// the high bit set is simply part of a token. The end of the data counts as
+	// a newline, so the data does not need to end in one.
 	size_t end = data.length();
-
 	size_t pos = 0;
+	auto next = [&data, &pos, end]() -> unsigned char
+	{
+		return pos < end ? data[pos++] : '\n';
+	};
+
 	// If the first character is the UTF8 byte order mark (BOM), skip it.
-	if(!Utf8::IsBOM(Utf8::DecodeCodePoint(data, pos)))
-		pos = 0;
+	if(data.starts_with("\xEF\xBB\xBF"))
+		pos = 3;
 
 	while(pos < end)
 	{
 		++lineNumber;
 		size_t tokenPos = pos;
-		char32_t c = Utf8::DecodeCodePoint(data, pos);
+		unsigned char c = next();
 
 		bool mixedIndentation = false;
 		int separators = 0;
@@ -140,16 +267,16 @@ void DataFile::LoadData(const string &data)
 
 			++separators;
 			tokenPos = pos;
-			c = Utf8::DecodeCodePoint(data, pos);
+			c = next();
 		}
 
 		// If the line is a comment, skip to the end of the line.
 		if(c == '#')
 		{
 			if(mixedIndentation)
-				root.PrintTrace("Mixed whitespace usage for comment at line " + to_string(lineNumber));
+				warnings.emplace_back(ROOT, "Mixed whitespace usage for comment at line " + to_string(lineNumber));
 			while(c != '\n')
-				c = Utf8::DecodeCodePoint(data, pos);
+				c = next();
 		}
 		// Skip empty lines (including comment lines).
 		if(c == '\n')
@@ -157,20 +284,23 @@ void DataFile::LoadData(const string &data)
 
 		// Determine where in the node tree we are inserting this node, based on
 		// whether it has more indentation that the previous node, less, or the same.
-		while(separatorStack.back() >= separators)
+		// All the nodes below a node have been read once a line with the same
+		// or less indentation is found.
+		while(!separatorStack.empty() && separatorStack.back() >= separators)
 		{
+			nodes[stack.back()].descendants = nodes.size() - stack.back() - 1;
 			separatorStack.pop_back();
 			stack.pop_back();
 		}
 
-		// Add this node as a child of the proper node.
-		list<DataNode> &children = stack.back()->children;
-		children.emplace_back(stack.back());
-		DataNode &node = children.back();
+		// Add this node after the last node that was read.
+		size_t index = nodes.size();
+		DataNode &node = nodes.emplace_back();
 		node.lineNumber = lineNumber;
+		node.tokenIndex = tokens.size();
 
 		// Remember where in the tree we are.
-		stack.push_back(&node);
+		stack.push_back(index);
 		separatorStack.push_back(separators);
 
 		// Tokenize the line. Skip comments and empty lines.
@@ -178,12 +308,12 @@ void DataFile::LoadData(const string &data)
 		{
 			// Check if this token begins with a quotation mark. If so, it will
 			// include everything up to the next instance of that mark.
-			char32_t endQuote = c;
+			unsigned char endQuote = c;
 			bool isQuoted = (endQuote == '"' || endQuote == '`');
 			if(isQuoted)
 			{
 				tokenPos = pos;
-				c = Utf8::DecodeCodePoint(data, pos);
+				c = next();
 			}
 
 			size_t endPos = tokenPos;
@@ -192,19 +322,14 @@ void DataFile::LoadData(const string &data)
 			while(c != '\n' && (isQuoted ? (c != endQuote) : (c > ' ')))
 			{
 				endPos = pos;
-				c = Utf8::DecodeCodePoint(data, pos);
+				c = next();
 			}
 
-			// It ought to be legal to construct a string from an empty iterator
-			// range, but it appears that some libraries do not handle that case
-			// correctly. So:
-			if(tokenPos == endPos)
-				node.tokens.emplace_back();
-			else
-				node.tokens.emplace_back(data, tokenPos, endPos - tokenPos);
+			tokens.emplace_back(data.substr(tokenPos, endPos - tokenPos));
+			++node.tokenCount;
 			// This is not a fatal error, but it may indicate a format mistake:
 			if(isQuoted && c == '\n')
-				node.PrintTrace("Closing quotation mark is missing:");
+				warnings.emplace_back(index, "Closing quotation mark is missing:");
 
 			if(c != '\n')
 			{
@@ -213,12 +338,12 @@ void DataFile::LoadData(const string &data)
 				if(isQuoted)
 				{
 					tokenPos = pos;
-					c = Utf8::DecodeCodePoint(data, pos);
+					c = next();
 				}
 				while(c != '\n' && c <= ' ' && c != '#')
 				{
 					tokenPos = pos;
-					c = Utf8::DecodeCodePoint(data, pos);
+					c = next();
 				}
 
 				// If a comment is encountered outside of a token, skip the rest
@@ -226,15 +351,25 @@ void DataFile::LoadData(const string &data)
 				if(c == '#')
 				{
 					while(c != '\n')
-						c = Utf8::DecodeCodePoint(data, pos);
+						c = next();
 				}
 			}
 		}
-		// Now that we've reached the end of the line, we know no more tokens will be added to the node.
-		node.tokens.shrink_to_fit();
-
 		// Now that we've tokenized this node, print any mixed whitespace warnings.
 		if(mixedIndentation)
-			node.PrintTrace("Mixed whitespace usage at line");
+			warnings.emplace_back(index, "Mixed whitespace usage at line");
 	}
+	// The end of the file ends every node that is still open.
+	for(size_t index : stack)
+		nodes[index].descendants = nodes.size() - index - 1;
+
+	// Now that all the nodes and tokens are in place, let them know where their
+	// parents and tokens are.
+	nodes.shrink_to_fit();
+	tokens.shrink_to_fit();
+	root.Relink();
+
+	hasWarnings |= !warnings.empty();
+	for(const auto &[index, message] : warnings)
+		(index == ROOT ? root : nodes[index]).PrintTrace(message);
 }
@@ -19,8 +19,8 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include <filesystem>
 #include <istream>
-#include <list>
 #include <string>
+#include <string_view>
 
 
 
@@ -40,16 +40,27 @@ public:
 	void Load(const std::filesystem::path &path);
 	void Load(std::istream &in);
 
+	// Save the nodes of this file in a compact binary form, which can be loaded
+	// much faster than parsing the text again. The given key is stored with the
+	// nodes, and must match when loading them.
+	std::string SaveBinary(const std::string &key) const;
+	// Load nodes that were saved by SaveBinary() with the same key. If the data
+	// is not valid, this returns false and leaves this file unchanged.
+	bool LoadBinary(std::string_view data, const std::string &key);
+	// Check if any warnings were printed while parsing this file.
+	bool HasWarnings() const;
+
 	// Functions for iterating through all DataNodes in this file.
-	std::list<DataNode>::const_iterator begin() const;
-	std::list<DataNode>::const_iterator end() const;
+	DataNode::ConstIterator begin() const;
+	DataNode::ConstIterator end() const;
 
 
 private:
-	void LoadData(const std::string &data);
+	void LoadData(std::string_view data);
 
 
 private:
 	// This is the container for all DataNodes in this file.
 	DataNode root;
+	bool hasWarnings = false;
 };
@@ -0,0 +1,92 @@
+/* DataFileQueue.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "DataFileQueue.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+
+
+DataFileQueue::DataFileQueue(vector<filesystem::path> files,
+		function<void(const filesystem::path &, DataFile &)> parse, size_t ahead)
+	: files(std::move(files)), parse(std::move(parse)), ahead(ahead),
+	parsed(this->files.size()), parsing(this->files.size()), claimed(this->files.size()),
+	errors(this->files.size())
+{
+	Submit(ahead);
+}
+
+
+
+DataFileQueue::~DataFileQueue()
+{
+	queue.Wait();
+}
+
+
+
+size_t DataFileQueue::Size() const
+{
+	return files.size();
+}
+
+
+
+const filesystem::path &DataFileQueue::Path(size_t index) const
+{
+	return files[index];
+}
+
+
+
+DataFile DataFileQueue::Take(size_t index)
+{
+	Submit(index + 1 + ahead);
+	// If another thread is parsing this file, wait for it to finish. The queue
+	// gives no task if it was shutting down, but then nothing can have claimed
+	// the file either.
+	if(!Parse(index) && parsing[index].valid())
+		parsing[index].wait();
+	if(errors[index])
+		rethrow_exception(errors[index]);
+
+	return std::move(parsed[index]);
+}
+
+
+
+bool DataFileQueue::Parse(size_t index)
+{
+	if(claimed[index].exchange(true, memory_order_acq_rel))
+		return false;
+	try {
+		parse(files[index], parsed[index]);
+	}
+	catch(...) {
+		errors[index] = current_exception();
+	}
+	return true;
+}
+
+
+
+void DataFileQueue::Submit(size_t end)
+{
+	for( ; submitted < min(files.size(), end); ++submitted)
+		parsing[submitted] = queue.Run([this, index = submitted] { Parse(index); });
+}
@@ -0,0 +1,77 @@
+/* DataFileQueue.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "DataFile.h"
+#include "TaskQueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <vector>
+
+
+
+// Class that parses a list of data files in parallel, a few files ahead of the
+// one that is needed next, so that the files can be taken one at a time in
+// order while the files after them are being parsed. If no thread has started
+// parsing a file by the time it is taken, the taking thread parses it itself.
+// An error in parsing a file is thrown when that file is taken, as if the
+// taking thread had parsed the file itself.
+class DataFileQueue {
+public:
+	// Parse the given files with the given function, at most the given
+	// number of files ahead of the one that is taken next.
+	DataFileQueue(std::vector<std::filesystem::path> files,
+		std::function<void(const std::filesystem::path &, DataFile &)> parse, size_t ahead);
+	DataFileQueue(const DataFileQueue &) = delete;
+	DataFileQueue &operator=(const DataFileQueue &) = delete;
+	// Wait for any files that are still being parsed.
+	~DataFileQueue();
+
+	size_t Size() const;
+	const std::filesystem::path &Path(size_t index) const;
+	// Get the parsed nodes of the file with the given index. The files must be
+	// taken in order, and each file can only be taken once.
+	DataFile Take(size_t index);
+
+
+private:
+	// Parse the given file, unless another thread already started on it.
+	// Returns false if it was left to the other thread.
+	bool Parse(size_t index);
+	// Start parsing every file up to the given index.
+	void Submit(size_t end);
+
+
+private:
+	const std::vector<std::filesystem::path> files;
+	const std::function<void(const std::filesystem::path &, DataFile &)> parse;
+	const size_t ahead;
+
+	std::vector<DataFile> parsed;
+	std::vector<std::shared_future<void>> parsing;
+	std::vector<std::atomic<bool>> claimed;
+	std::vector<std::exception_ptr> errors;
+	size_t submitted = 0;
+
+	// The queue is destroyed first, so every task that it runs is finished
+	// before anything that the tasks refer to is gone.
+	TaskQueue queue;
+};
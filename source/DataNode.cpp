@@ -21,28 +21,25 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <functional>
 
 using namespace std;
 
 
 
 // Construct a DataNode and remember what its parent is.
-DataNode::DataNode(const DataNode *parent) noexcept(false)
+DataNode::DataNode(const DataNode *parent) noexcept
 	: parent(parent)
 {
-	// To avoid a lot of memory reallocation, have every node start out with
-	// capacity for four tokens. This makes file loading slightly faster, at the
-	// cost of DataFiles taking up a bit more memory.
-	tokens.reserve(4);
 }
 
 
 
 // Copy constructor.
 DataNode::DataNode(const DataNode &other)
-	: children(other.children), tokens(other.tokens), lineNumber(std::move(other.lineNumber))
+	: lineNumber(other.lineNumber)
 {
-	Reparent();
+	CopyFrom(other);
 }
 
 
@@ -50,18 +47,24 @@ DataNode::DataNode(const DataNode &other)
 // Copy assignment operator.
 DataNode &DataNode::operator=(const DataNode &other)
 {
-	children = other.children;
-	tokens = other.tokens;
-	lineNumber = std::move(other.lineNumber);
-	Reparent();
+	if(&other != this)
+	{
+		lineNumber = other.lineNumber;
+		CopyFrom(other);
+	}
 	return *this;
 }
 
 
 
 DataNode::DataNode(DataNode &&other) noexcept
-	: children(std::move(other.children)), tokens(std::move(other.tokens)), lineNumber(other.lineNumber)
+	: storage(std::move(other.storage)), tokens(other.tokens), tokenIndex(other.tokenIndex),
+	tokenCount(other.tokenCount), descendants(other.descendants), lineNumber(other.lineNumber)
 {
+	other.tokens = nullptr;
+	other.tokenCount = 0;
+	other.descendants = 0;
+
 	Reparent();
 }
 
@@ -69,27 +72,41 @@ DataNode::DataNode(DataNode &&other) noexcept
 
 DataNode &DataNode::operator=(DataNode &&other) noexcept
 {
-	children.swap(other.children);
-	tokens.swap(other.tokens);
+	if(&other == this)
+		return *this;
+
+	storage = std::move(other.storage);
+	tokens = other.tokens;
+	tokenIndex = other.tokenIndex;
+	tokenCount = other.tokenCount;
+	descendants = other.descendants;
 	lineNumber = other.lineNumber;
+	other.tokens = nullptr;
+	other.tokenCount = 0;
+	other.descendants = 0;
+
 	Reparent();
 	return *this;
 }
 
 
 
+DataNode::~DataNode() noexcept = default;
+
+
+
 // Get the number of tokens in this line of the data file.
 int DataNode::Size() const noexcept
 {
-	return tokens.size();
+	return tokenCount;
 }
 
 
 
 // Get all tokens.
-const vector<string> &DataNode::Tokens() const noexcept
+span<const string> DataNode::Tokens() const noexcept
 {
-	return tokens;
+	return span<const string>(tokens, tokenCount);
 }
 
 
@@ -97,7 +114,10 @@ const vector<string> &DataNode::Tokens() const noexcept
 // Add tokens to the node.
 void DataNode::AddToken(const string &token)
 {
-	tokens.emplace_back(token);
+	Storage &own = Own();
+	own.ownTokens.emplace_back(token);
+	tokens = own.ownTokens.data();
+	tokenCount = own.ownTokens.size();
 }
 
 
@@ -107,7 +127,7 @@ void DataNode::AddToken(const string &token)
 const string &DataNode::Token(int index) const
 {
 	static const string ERROR = "";
-	if(static_cast<size_t>(index) >= tokens.size())
+	if(static_cast<unsigned>(index) >= tokenCount)
 	{
 		PrintTrace("Requested token index (" + to_string(index) + ") is out of bounds:");
 		return ERROR;
@@ -121,7 +141,7 @@ const string &DataNode::Token(int index) const
 double DataNode::Value(int index) const
 {
 	// Check for empty strings and out-of-bounds indices.
-	if(static_cast<size_t>(index) >= tokens.size() || tokens[index].empty())
+	if(static_cast<unsigned>(index) >= tokenCount || tokens[index].empty())
 		PrintTrace("Requested token index (" + to_string(index) + ") is out of bounds:");
 	else if(!IsNumber(tokens[index]))
 		PrintTrace("Cannot convert value \"" + tokens[index] + "\" to a number:");
@@ -190,7 +210,7 @@ double DataNode::Value(const string &token)
 bool DataNode::IsNumber(int index) const
 {
 	// Make sure this token exists and is not empty.
-	if(static_cast<size_t>(index) >= tokens.size() || tokens[index].empty())
+	if(static_cast<unsigned>(index) >= tokenCount || tokens[index].empty())
 		return false;
 
 	return IsNumber(tokens[index]);
@@ -242,7 +262,7 @@ bool DataNode::IsNumber(const string &token)
 bool DataNode::BoolValue(int index) const
 {
 	// Check for empty strings and out-of-bounds indices.
-	if(static_cast<size_t>(index) >= tokens.size() || tokens[index].empty())
+	if(static_cast<unsigned>(index) >= tokenCount || tokens[index].empty())
 		PrintTrace("Requested token index (" + to_string(index) + ") is out of bounds:");
 	else if(!IsBool(tokens[index]))
 		PrintTrace("Cannot convert value \"" + tokens[index] + "\" to a boolean:");
@@ -262,7 +282,7 @@ bool DataNode::BoolValue(int index) const
 bool DataNode::IsBool(int index) const
 {
 	// Make sure this token exists and is not empty.
-	if(static_cast<size_t>(index) >= tokens.size() || tokens[index].empty())
+	if(static_cast<unsigned>(index) >= tokenCount || tokens[index].empty())
 		return false;
 
 	return IsBool(tokens[index]);
@@ -294,10 +314,37 @@ bool DataNode::IsConditionName(const string &token)
 
 
 
-// Add a new child. The child's parent must be this node.
+// Add a copy of the given node, and all of its children, as a new child.
 void DataNode::AddChild(const DataNode &child)
 {
-	children.emplace_back(child);
+	// Adding to this node's tree may move the nodes in it, so if the child is
+	// part of that tree, it must be copied first.
+	const DataNode *first = DescendantsBegin();
+	const DataNode *last = DescendantsEnd();
+	if(&child == this || (less_equal<const DataNode *>()(first, &child) && less<const DataNode *>()(&child, last)))
+	{
+		AddChild(DataNode(child));
+		return;
+	}
+
+	Storage &own = Own();
+	const DataNode *childBegin = child.DescendantsBegin();
+	const DataNode *childEnd = child.DescendantsEnd();
+	own.nodes.reserve(own.nodes.size() + 1 + (childEnd - childBegin));
+	auto append = [&own](const DataNode &node, size_t descendants)
+	{
+		DataNode &copy = own.nodes.emplace_back();
+		copy.tokenIndex = own.tokens.size();
+		copy.tokenCount = node.tokenCount;
+		copy.descendants = descendants;
+		copy.lineNumber = node.lineNumber;
+		own.tokens.insert(own.tokens.end(), node.tokens, node.tokens + node.tokenCount);
+	};
+	append(child, childEnd - childBegin);
+	for(const DataNode *it = childBegin; it != childEnd; ++it)
+		append(*it, it->descendants);
+
+	Relink();
 }
 
 
@@ -305,23 +352,23 @@ void DataNode::AddChild(const DataNode &child)
 // Check if this node has any children.
 bool DataNode::HasChildren() const noexcept
 {
-	return !children.empty();
+	return DescendantsBegin() != DescendantsEnd();
 }
 
 
 
-// Iterator to the beginning of the list of children.
-list<DataNode>::const_iterator DataNode::begin() const noexcept
+// Iterator to the first child.
+DataNode::ConstIterator DataNode::begin() const noexcept
 {
-	return children.begin();
+	return ConstIterator(DescendantsBegin());
 }
 
 
 
-// Iterator to the end of the list of children.
-list<DataNode>::const_iterator DataNode::end() const noexcept
+// Iterator to the end of the children.
+DataNode::ConstIterator DataNode::end() const noexcept
 {
-	return children.end();
+	return ConstIterator(DescendantsEnd());
 }
 
 
@@ -337,15 +384,15 @@ int DataNode::PrintTrace(const string &message) const
 	size_t indent = 0;
 	if(parent)
 		indent = parent->PrintTrace() + 2;
-	if(tokens.empty())
+	if(!tokenCount)
 		return indent;
 
 	// Convert this node back to tokenized text, with quotes used as necessary.
 	string line = !parent ? "" : "L" + to_string(lineNumber) + ": ";
 	line.append(string(indent, ' '));
-	for(const string &token : tokens)
+	for(const string &token : Tokens())
 	{
-		if(&token != &tokens.front())
+		if(&token != tokens)
 			line += ' ';
 		line += DataWriter::Quote(token);
 	}
@@ -357,12 +404,105 @@ int DataNode::PrintTrace(const string &message) const
 
 
 
-// Adjust the parent pointers when a copy is made of a DataNode.
+// Get the storage of the tree that this node is the top of, creating it if necessary.
+DataNode::Storage &DataNode::Own()
+{
+	if(!storage)
+		storage = make_unique<Storage>();
+	return *storage;
+}
+
+
+
+// Get the range of nodes below this one.
+const DataNode *DataNode::DescendantsBegin() const noexcept
+{
+	return storage ? storage->nodes.data() : this + 1;
+}
+
+
+
+const DataNode *DataNode::DescendantsEnd() const noexcept
+{
+	return storage ? storage->nodes.data() + storage->nodes.size() : this + 1 + descendants;
+}
+
+
+
+// Make this node the top of a new tree holding a copy of the given node's
+// tokens and descendants.
+void DataNode::CopyFrom(const DataNode &other)
+{
+	// Build the new tree before replacing the old one, in case the other node is part of it.
+	unique_ptr<Storage> copy;
+	const DataNode *first = other.DescendantsBegin();
+	const DataNode *last = other.DescendantsEnd();
+	if(other.tokenCount || first != last)
+	{
+		copy = make_unique<Storage>();
+		copy->ownTokens.assign(other.tokens, other.tokens + other.tokenCount);
+		copy->nodes.reserve(last - first);
+		// The tokens of the other node's descendants are usually stored together.
+		if(first != last)
+			copy->tokens.reserve((last - 1)->tokenIndex + (last - 1)->tokenCount - first->tokenIndex);
+		for(const DataNode *it = first; it != last; ++it)
+		{
+			DataNode &node = copy->nodes.emplace_back();
+			node.tokenIndex = copy->tokens.size();
+			node.tokenCount = it->tokenCount;
+			node.descendants = it->descendants;
+			node.lineNumber = it->lineNumber;
+			copy->tokens.insert(copy->tokens.end(), it->tokens, it->tokens + it->tokenCount);
+		}
+	}
+
+	storage = std::move(copy);
+	tokens = nullptr;
+	tokenCount = 0;
+	descendants = 0;
+	Relink();
+}
+
+
+
+// Update the parent pointers of this node's children after it has moved.
 void DataNode::Reparent() noexcept
 {
-	for(DataNode &child : children)
+	// The storage itself did not move, so only the children need a new parent.
+	// Nodes within a tree are only moved while the tree is being built, and are
+	// relinked once it is done.
+	if(!storage)
+		return;
+	DataNode *end = storage->nodes.data() + storage->nodes.size();
+	for(DataNode *child = storage->nodes.data(); child != end; child += 1 + child->descendants)
+		child->parent = this;
+}
+
+
+
+// Set the parent and token pointers of all the nodes in this node's tree,
+// after it has been built or the storage has moved.
+void DataNode::Relink()
+{
+	if(!storage)
+		return;
+
+	tokens = storage->ownTokens.data();
+	tokenCount = storage->ownTokens.size();
+
+	// Keep track of the nodes whose descendants are being visited, and of where
+	// their descendants end.
+	vector<pair<DataNode *, size_t>> stack;
+	vector<DataNode> &nodes = storage->nodes;
+	for(size_t i = 0; i < nodes.size(); ++i)
 	{
-		child.parent = this;
-		child.Reparent();
+		while(!stack.empty() && stack.back().second <= i)
+			stack.pop_back();
+
+		DataNode &node = nodes[i];
+		node.parent = stack.empty() ? this : stack.back().first;
+		node.tokens = storage->tokens.data() + node.tokenIndex;
+		if(node.descendants)
+			stack.emplace_back(&node, i + 1 + node.descendants);
 	}
 }
@@ -15,8 +15,11 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <list>
+#include <iterator>
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -28,22 +31,55 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 // The tokens of a node are separated by white space, with quotation marks being
 // used to group multiple words into a single token. If the token text contains
 // quotation marks, it should be enclosed in backticks instead.
+//
+// To avoid allocating memory for every single node, a tree of nodes is stored
+// in one contiguous block: each node is directly followed by all the nodes
+// below it, and the tokens of all the nodes are stored together. The top node
+// of a tree owns that storage; a copy of any node is the top of a new tree.
 class DataNode {
+public:
+	// Iterator over the children of a node. Since each node is followed by all
+	// of its descendants, the next child is found by skipping over those.
+	class ConstIterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = DataNode;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const DataNode *;
+		using reference = const DataNode &;
+
+		ConstIterator() noexcept = default;
+		explicit ConstIterator(const DataNode *node) noexcept;
+
+		const DataNode &operator*() const noexcept;
+		const DataNode *operator->() const noexcept;
+		ConstIterator &operator++() noexcept;
+		ConstIterator operator++(int) noexcept;
+		bool operator==(const ConstIterator &other) const noexcept;
+		bool operator!=(const ConstIterator &other) const noexcept;
+
+	private:
+		const DataNode *node = nullptr;
+	};
+
+
 public:
 	// Construct a DataNode. For the purpose of printing stack traces, each node
 	// must remember what its parent node is.
-	explicit DataNode(const DataNode *parent = nullptr) noexcept(false);
+	explicit DataNode(const DataNode *parent = nullptr) noexcept;
 	// Copying or moving a DataNode requires updating the parent pointers.
 	DataNode(const DataNode &other);
 	DataNode &operator=(const DataNode &other);
 	DataNode(DataNode &&) noexcept;
 	DataNode &operator=(DataNode &&) noexcept;
+	~DataNode() noexcept;
 
 	// Get the number of tokens in this node.
 	int Size() const noexcept;
-	// Get all the tokens in this node as an iterable vector.
-	const std::vector<std::string> &Tokens() const noexcept;
-	// Add tokens to the node.
+	// Get all the tokens in this node as an iterable range.
+	std::span<const std::string> Tokens() const noexcept;
+	// Add tokens to the node. Only a node that is the top of its tree, i.e. one
+	// that was not loaded from a file or copied as part of another node, can be modified.
 	void AddToken(const std::string &token);
 	// Get the token at the given index. DataFile loading guarantees index 0 always exists.
 	// If the index is out of range, then this returns an empty string and prints an error.
@@ -67,28 +103,47 @@ public:
 	// Check if the token can be used as name for a condition.
 	static bool IsConditionName(const std::string &token);
 
-	// Add a new child. The child's parent must be this node.
+	// Add a copy of the given node, and all of its children, as a new child.
 	void AddChild(const DataNode &child);
 	// Check if this node has any children. If so, the iterator functions below
 	// can be used to access them.
 	bool HasChildren() const noexcept;
-	std::list<DataNode>::const_iterator begin() const noexcept;
-	std::list<DataNode>::const_iterator end() const noexcept;
+	ConstIterator begin() const noexcept;
+	ConstIterator end() const noexcept;
 
 	// Print a message followed by a "trace" of this node and its parents.
 	int PrintTrace(const std::string &message = "") const;
 
 
 private:
-	// Adjust the parent pointers when a copy is made of a DataNode.
+	class Storage;
+
+	// Get the storage of the tree that this node is the top of, creating it if necessary.
+	Storage &Own();
+	// Get the range of nodes below this one.
+	const DataNode *DescendantsBegin() const noexcept;
+	const DataNode *DescendantsEnd() const noexcept;
+	// Make this node the top of a new tree holding a copy of the given node's
+	// tokens and descendants.
+	void CopyFrom(const DataNode &other);
+	// Update the parent pointers of this node's children after it has moved.
 	void Reparent() noexcept;
+	// Set the parent and token pointers of all the nodes in this node's tree,
+	// after it has been built or the storage has moved.
+	void Relink();
 
 
 private:
-	// These are "child" nodes found on subsequent lines with deeper indentation.
-	std::list<DataNode> children;
+	// If this node is the top of a tree, this holds all the nodes below it and
+	// their tokens. Nodes within a tree do not have storage of their own.
+	std::unique_ptr<Storage> storage;
 	// These are the tokens found in this particular line of the data file.
-	std::vector<std::string> tokens;
+	const std::string *tokens = nullptr;
+	// Where the tokens of this node are within the storage of its tree.
+	uint32_t tokenIndex = 0;
+	uint32_t tokenCount = 0;
+	// The number of nodes below this one, which are stored right after it.
+	uint32_t descendants = 0;
 	// The parent pointer is used only for printing stack traces.
 	const DataNode *parent = nullptr;
 	// The line number in the given file that produced this node.
@@ -97,3 +152,39 @@ private:
 	// Allow DataFile to modify the internal structure of DataNodes.
 	friend class DataFile;
 };
+
+
+
+class DataNode::Storage {
+public:
+	// The tokens of the node at the top of the tree.
+	std::vector<std::string> ownTokens;
+	// All the other nodes in the tree, in depth-first order, and their tokens.
+	std::vector<DataNode> nodes;
+	std::vector<std::string> tokens;
+};
+
+
+
+inline DataNode::ConstIterator::ConstIterator(const DataNode *node) noexcept : node(node) {}
+inline const DataNode &DataNode::ConstIterator::operator*() const noexcept { return *node; }
+inline const DataNode *DataNode::ConstIterator::operator->() const noexcept { return node; }
+inline DataNode::ConstIterator &DataNode::ConstIterator::operator++() noexcept
+{
+	node += 1 + node->descendants;
+	return *this;
+}
+inline DataNode::ConstIterator DataNode::ConstIterator::operator++(int) noexcept
+{
+	ConstIterator result = *this;
+	++*this;
+	return result;
+}
+inline bool DataNode::ConstIterator::operator==(const ConstIterator &other) const noexcept
+{
+	return node == other.node;
+}
+inline bool DataNode::ConstIterator::operator!=(const ConstIterator &other) const noexcept
+{
+	return node != other.node;
+}
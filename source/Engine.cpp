@@ -52,6 +52,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "PlayerInfo.h"
 #include "shader/PointerShader.h"
 #include "Preferences.h"
+#include "Profiler.h"
 #include "Projectile.h"
 #include "Random.h"
 #include "shader/RingShader.h"
@@ -79,6 +80,8 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <algorithm>
 #include <cmath>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 using namespace std;
 
@@ -244,6 +247,9 @@ namespace {
 	}
 
 	const double MAX_FUEL_DISPLAY = 3000.;
+
+	// How many jumps ahead the sprites of the flagship's route are loaded.
+	const size_t PREFETCH_JUMPS = 3;
 }
 
 
@@ -493,6 +499,15 @@ void Engine::Place(const list<NPC> &npcs, const shared_ptr<Ship> &flagship)
 
 
 
+// Add ships that were already placed in the player's system, e.g. by
+// Fleet::Place(). The given list is emptied.
+void Engine::Place(list<shared_ptr<Ship>> &placed)
+{
+	ships.splice(ships.end(), placed);
+}
+
+
+
 // Wait for the previous calculations (if any) to be done.
 void Engine::Wait()
 {
@@ -505,6 +520,8 @@ void Engine::Wait()
 // Begin the next step of calculations.
 void Engine::Step(bool isActive)
 {
+	Profiler::Scope scope("Engine::Step");
+
 	events.swap(eventQueue);
 	eventQueue.clear();
 
@@ -676,6 +693,8 @@ void Engine::Step(bool isActive)
 			player.TravelPlan().clear();
 		}
 	}
+	if(flagship && !flagship->IsDestroyed())
+		PrefetchRoute(*flagship);
 	if(doFlash)
 	{
 		flash = .4;
@@ -1211,6 +1230,8 @@ list<ShipEvent> &Engine::Events()
 // Draw a frame.
 void Engine::Draw() const
 {
+	Profiler::Scope scope("Engine::Draw");
+
 	++uiStep;
 
 	Point motionBlur = camera.Velocity();
@@ -1655,8 +1676,58 @@ void Engine::EnterSystem()
 
 
 
+void Engine::PrefetchRoute(const Ship &flagship)
+{
+	// The next systems are the targeted one, followed by the rest of the travel plan.
+	vector<const System *> route;
+	const System *target = flagship.GetTargetSystem();
+	if(target && target != flagship.GetSystem())
+		route.push_back(target);
+	const vector<const System *> &plan = player.TravelPlan();
+	for(auto it = plan.rbegin(); it != plan.rend() && route.size() < PREFETCH_JUMPS; ++it)
+		if(find(route.begin(), route.end(), *it) == route.end())
+			route.push_back(*it);
+
+	// Only schedule new loads when the route changes, not every frame.
+	const Planet *destination = player.TravelDestination();
+	if(route == prefetchedRoute && destination == prefetchedDestination)
+		return;
+	prefetchedRoute = route;
+	prefetchedDestination = destination;
+	if(route.empty())
+		return;
+
+	// Nearer systems come first, so that they are loaded if the budget runs out.
+	vector<const Sprite *> sprites;
+	for(const System *system : route)
+		for(const StellarObject &object : system->Objects())
+			if(object.HasSprite())
+				sprites.push_back(object.GetSprite());
+
+	// If the end of the route is in reach, the player will likely land there,
+	// most likely on the destination they picked, if any.
+	const System *last = plan.empty() ? route.back() : plan.front();
+	if(last == route.back())
+	{
+		if(destination && destination->IsInSystem(last))
+			sprites.push_back(destination->Landscape());
+		for(const StellarObject &object : last->Objects())
+		{
+			const Planet *planet = object.HasValidPlanet() ? object.GetPlanet() : nullptr;
+			if(planet && planet != destination && !planet->IsWormhole() && planet->CanLand())
+				sprites.push_back(planet->Landscape());
+		}
+	}
+
+	SpriteLoadManager::Prefetch(asyncQueue, sprites);
+}
+
+
+
 void Engine::CalculateStep()
 {
+	Profiler::Scope scope("Engine::CalculateStep");
+
 	// If there is a pending zoom update then use it
 	// because the zoom will get updated in the main thread
 	// as soon as the calculation thread is finished.
@@ -1703,6 +1774,8 @@ void Engine::CalculateStep()
 	// Populate the radar.
 	FillRadar();
 
+	// Fill the lists of things to draw.
+	Profiler::Scope drawScope("Engine::BuildDrawLists");
 	// Draw the planets.
 	for(const StellarObject &object : playerSystem->Objects())
 		if(object.HasSprite())
@@ -1782,7 +1855,7 @@ void Engine::CalculateStep()
 void Engine::CalculateUnpaused(const Ship *flagship, const System *playerSystem)
 {
 	// Now, all the ships must decide what they are doing next.
-	ai.Step(activeCommands);
+	ai.Step(activeCommands, workQueue);
 
 	// Clear the active player's commands, because they are all processed at this point.
 	activeCommands.Clear();
@@ -1799,30 +1872,43 @@ void Engine::CalculateUnpaused(const Ship *flagship, const System *playerSystem)
 	// Keep track of the flagship to see if it jumps or enters a wormhole this frame.
 	bool flagshipWasUntargetable = (flagship && !flagship->IsTargetable());
 	bool wasHyperspacing = (flagship && flagship->IsEnteringHyperspace());
-	// First, move the player's flagship.
-	if(flagship)
-	{
-		emptySoundsTimer.resize(flagship->Weapons().size());
-		for(int &it : emptySoundsTimer)
-			if(it > 0)
-				--it;
-		MoveShip(player.FlagshipPtr());
-	}
-	const System *flagshipSystem = (flagship ? flagship->GetSystem() : nullptr);
-	bool flagshipIsTargetable = (flagship && flagship->IsTargetable());
-	bool flagshipBecameTargetable = flagshipWasUntargetable && flagshipIsTargetable;
-	// Then, move the other ships.
-	for(const shared_ptr<Ship> &it : ships)
 	{
-		if(it == player.FlagshipPtr())
-			continue;
-		bool wasUntargetable = !it->IsTargetable();
-		MoveShip(it);
-		bool isTargetable = it->IsTargetable();
-		if(flagshipSystem == it->GetSystem()
-			&& ((wasUntargetable && isTargetable) || flagshipBecameTargetable)
-			&& isTargetable && flagshipIsTargetable)
-				eventQueue.emplace_back(player.FlagshipPtr(), it, ShipEvent::ENCOUNTER);
+		Profiler::Scope scope("Engine::MoveShips");
+		// First, move the player's flagship.
+		if(moveOutputs.empty())
+			moveOutputs.resize(1);
+		if(flagship)
+		{
+			emptySoundsTimer.resize(flagship->Weapons().size());
+			for(int &it : emptySoundsTimer)
+				if(it > 0)
+					--it;
+			MoveShip(player.FlagshipPtr(), moveOutputs.front());
+			MergeMoveOutput(moveOutputs.front());
+		}
+		const System *flagshipSystem = (flagship ? flagship->GetSystem() : nullptr);
+		bool flagshipIsTargetable = (flagship && flagship->IsTargetable());
+		bool flagshipBecameTargetable = flagshipWasUntargetable && flagshipIsTargetable;
+		// Then, move the other ships.
+		auto moveOtherShip = [&](const shared_ptr<Ship> &it, ShipMoveOutput &output)
+		{
+			bool wasUntargetable = !it->IsTargetable();
+			MoveShip(it, output);
+			bool isTargetable = it->IsTargetable();
+			if(flagshipSystem == it->GetSystem()
+				&& ((wasUntargetable && isTargetable) || flagshipBecameTargetable)
+				&& isTargetable && flagshipIsTargetable)
+					output.events.emplace_back(player.FlagshipPtr(), it, ShipEvent::ENCOUNTER);
+		};
+		if(Preferences::Has("Parallel ship movement"))
+			MoveShipsInParallel(moveOtherShip);
+		else
+		{
+			for(const shared_ptr<Ship> &it : ships)
+				if(it != player.FlagshipPtr())
+					moveOtherShip(it, moveOutputs.front());
+			MergeMoveOutput(moveOutputs.front());
+		}
 	}
 	// If the flagship just began jumping, play the appropriate sound.
 	if(!wasHyperspacing && flagship && flagship->IsEnteringHyperspace())
@@ -1842,7 +1928,7 @@ void Engine::CalculateUnpaused(const Ship *flagship, const System *playerSystem)
 		// Begin loading the sprites in the next system.
 		for(const StellarObject &object : flagship->GetTargetSystem()->Objects())
 			if(object.HasSprite())
-				SpriteLoadManager::LoadDeferred(asyncQueue, object.GetSprite());
+				SpriteLoadManager::LoadDeferred(asyncQueue, object.GetSprite(), SpriteLoadManager::Priority::NEIGHBOR);
 	}
 	// Check if the flagship just entered a new system.
 	if(flagship && playerSystem != flagship->GetSystem())
@@ -1917,9 +2003,22 @@ void Engine::CalculateUnpaused(const Ship *flagship, const System *playerSystem)
 	// Populate the collision detection lookup sets.
 	FillCollisionSets();
 
-	// Perform collision detection.
-	for(Projectile &projectile : projectiles)
-		DoCollisions(projectile);
+	// Perform collision detection. Finding what each projectile might hit only
+	// reads the collision sets, so it is spread over the worker threads. The hits
+	// are then applied in order, with the same results as handling each projectile
+	// in turn.
+	{
+		Profiler::Scope scope("Engine::DoCollisions");
+		if(projectileHits.size() < projectiles.size())
+			projectileHits.resize(projectiles.size());
+		workQueue.ParallelFor(projectiles.size(), 64, [this](size_t begin, size_t end)
+		{
+			for(size_t i = begin; i < end; ++i)
+				FindCollisions(projectiles[i], projectileHits[i]);
+		});
+		for(size_t i = 0; i < projectiles.size(); ++i)
+			DoCollisions(projectiles[i], projectileHits[i]);
+	}
 	// Now that collision detection is done, clear the cache of ships with anti-
 	// missile systems ready to fire.
 	hasAntiMissile.clear();
@@ -1945,7 +2044,7 @@ void Engine::CalculateUnpaused(const Ship *flagship, const System *playerSystem)
 
 // Move a ship. Also determine if the ship should generate hyperspace sounds or
 // boarding events, fire weapons, and launch fighters.
-void Engine::MoveShip(const shared_ptr<Ship> &ship)
+void Engine::MoveShip(const shared_ptr<Ship> &ship, ShipMoveOutput &output)
 {
 	// Various actions a ship could have taken last frame may have impacted the accuracy of cached values.
 	// Therefore, determine with any information needs recalculated and cache it.
@@ -1960,8 +2059,8 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 	bool wasHyperspacing = ship->IsHyperspacing();
 	// Give the ship the list of visuals so that it can draw explosions,
 	// ion sparks, jump drive flashes, etc.
-	ship->Move(newVisuals, newFlotsam);
-	eventQueue.splice(eventQueue.end(), ship->HandleEvents());
+	ship->Move(output.visuals, output.flotsam);
+	output.events.splice(output.events.end(), ship->HandleEvents());
 
 	// Bail out if the ship just died.
 	if(ship->ShouldBeRemoved())
@@ -1970,7 +2069,7 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 		{
 			// If this is a player ship, make sure it's no longer selected.
 			if(ship->IsYours())
-				player.DeselectEscort(ship.get());
+				output.deselect.push_back(ship.get());
 		}
 		return;
 	}
@@ -2019,7 +2118,7 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 	// The player should not become a docked passenger on some other ship, but AI ships may.
 	shared_ptr<Ship> victim = ship->Board(autoPlunder, isFlagship);
 	if(victim)
-		eventQueue.emplace_back(ship, victim,
+		output.events.emplace_back(ship, victim,
 			ship->GetGovernment()->IsEnemy(victim->GetGovernment()) ?
 				ShipEvent::BOARD : ShipEvent::ASSIST);
 
@@ -2028,17 +2127,150 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 		return;
 
 	// Launch fighters.
-	ship->Launch(newShips, newVisuals);
+	ship->Launch(output.ships, output.visuals);
 
 	// Fire weapons.
-	ship->Fire(newProjectiles, newVisuals, ship.get() == flagship ? &emptySoundsTimer : nullptr);
+	ship->Fire(output.projectiles, output.visuals, ship.get() == flagship ? &emptySoundsTimer : nullptr);
 
 	// Anti-missile and tractor beam systems are fired separately from normal weaponry.
 	// Track which ships have at least one such system ready to fire.
 	if(ship->HasAntiMissile())
-		hasAntiMissile.push_back(ship.get());
+		output.hasAntiMissile.push_back(ship.get());
 	if(ship->HasTractorBeam())
-		hasTractorBeam.push_back(ship.get());
+		output.hasTractorBeam.push_back(ship.get());
+}
+
+
+
+// Ships that read or modify each other while moving (a ship and its target, its
+// parent, its escorts, or the ships it carries) are grouped together and moved
+// in their usual order by a single task. Different groups do not interact, so
+// they can be moved at the same time. Each ship writes to its own output buffer,
+// and each group draws from its own random number stream, so the outcome does
+// not depend on how many worker threads there are or how the groups are scheduled.
+void Engine::MoveShipsInParallel(const function<void(const shared_ptr<Ship> &, ShipMoveOutput &)> &moveShip)
+{
+	vector<shared_ptr<Ship>> toMove;
+	toMove.reserve(ships.size());
+	for(const shared_ptr<Ship> &it : ships)
+		if(it != player.FlagshipPtr())
+			toMove.push_back(it);
+	if(toMove.empty())
+		return;
+	if(moveOutputs.size() < toMove.size())
+		moveOutputs.resize(toMove.size());
+
+	// Union-find over every ship a moving ship may touch, including ships that
+	// are not moving this step (e.g. the flagship, or ships being carried).
+	unordered_map<const Ship *, size_t> index;
+	vector<size_t> root;
+	auto Find = [&root](size_t i)
+	{
+		while(root[i] != i)
+			i = root[i] = root[root[i]];
+		return i;
+	};
+	auto Node = [&index, &root](const Ship *ship)
+	{
+		auto it = index.emplace(ship, root.size());
+		if(it.second)
+			root.push_back(root.size());
+		return it.first->second;
+	};
+	auto Join = [&Find, &Node, &root](size_t i, const Ship *other)
+	{
+		if(!other)
+			return;
+		size_t a = Find(i);
+		size_t b = Find(Node(other));
+		// Always keep the lower index as the root, so each group is identified by its first ship.
+		if(a != b)
+			root[max(a, b)] = min(a, b);
+	};
+	for(const shared_ptr<Ship> &ship : toMove)
+		Node(ship.get());
+	for(size_t i = 0; i < toMove.size(); ++i)
+	{
+		const Ship &ship = *toMove[i];
+		Join(i, ship.GetTargetShip().get());
+		Join(i, ship.GetShipToAssist().get());
+		Join(i, ship.GetParent().get());
+		for(const weak_ptr<Ship> &escort : ship.GetEscorts())
+			Join(i, escort.lock().get());
+		for(const Ship::Bay &bay : ship.Bays())
+			Join(i, bay.ship.get());
+	}
+
+	// Collect the groups in the order of their first ship. Each group gets a
+	// seed drawn in that same order, so the random numbers used by a group do
+	// not depend on the order in which the groups happen to be processed.
+	vector<vector<size_t>> groups;
+	vector<uint64_t> seeds;
+	vector<size_t> groupOf(toMove.size());
+	for(size_t i = 0; i < toMove.size(); ++i)
+	{
+		size_t first = Find(i);
+		if(first == i)
+		{
+			groupOf[i] = groups.size();
+			groups.emplace_back();
+			uint64_t seed = static_cast<uint64_t>(Random::Int()) << 32;
+			seeds.push_back(seed | Random::Int());
+		}
+		else
+			groupOf[i] = groupOf[first];
+		groups[groupOf[i]].push_back(i);
+	}
+
+	auto MoveGroups = [&](size_t begin, size_t end)
+	{
+		for(size_t g = begin; g < end; ++g)
+		{
+			Random::Stream stream(seeds[g]);
+			for(size_t i : groups[g])
+				moveShip(toMove[i], moveOutputs[i]);
+		}
+	};
+
+	// Split the groups into contiguous batches of roughly equal numbers of ships.
+	const size_t batchCount = min<size_t>(groups.size(), max(1u, thread::hardware_concurrency()));
+	const size_t shipsPerBatch = (toMove.size() + batchCount - 1) / batchCount;
+	vector<size_t> batchEnds;
+	for(size_t count = 0, g = 0; g < groups.size(); ++g)
+	{
+		count += groups[g].size();
+		if(count < shipsPerBatch && g + 1 < groups.size())
+			continue;
+		batchEnds.push_back(g + 1);
+		count = 0;
+	}
+	workQueue.ParallelFor(batchEnds.size(), 1, [&MoveGroups, &batchEnds](size_t begin, size_t end)
+	{
+		for(size_t b = begin; b < end; ++b)
+			MoveGroups(b ? batchEnds[b - 1] : 0, batchEnds[b]);
+	});
+
+	// Merge the results in the order the ships would have been moved in serially.
+	for(size_t i = 0; i < toMove.size(); ++i)
+		MergeMoveOutput(moveOutputs[i]);
+}
+
+
+
+void Engine::MergeMoveOutput(ShipMoveOutput &output)
+{
+	Append(newVisuals, output.visuals);
+	Append(newProjectiles, output.projectiles);
+	newFlotsam.splice(newFlotsam.end(), output.flotsam);
+	newShips.splice(newShips.end(), output.ships);
+	eventQueue.splice(eventQueue.end(), output.events);
+	hasAntiMissile.insert(hasAntiMissile.end(), output.hasAntiMissile.begin(), output.hasAntiMissile.end());
+	output.hasAntiMissile.clear();
+	hasTractorBeam.insert(hasTractorBeam.end(), output.hasTractorBeam.begin(), output.hasTractorBeam.end());
+	output.hasTractorBeam.clear();
+	for(const Ship *ship : output.deselect)
+		player.DeselectEscort(ship);
+	output.deselect.clear();
 }
 
 
@@ -2046,6 +2278,8 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 // Populate the ship collision detection set for projectile & flotsam computations.
 void Engine::FillCollisionSets()
 {
+	Profiler::Scope scope("Engine::FillCollisionSets");
+
 	shipCollisions.Clear(step);
 	for(const shared_ptr<Ship> &it : ships)
 		if(it->GetSystem() == player.GetSystem() && it->Zoom() == 1.)
@@ -2444,15 +2678,42 @@ void Engine::HandleMouseInput(Command &activeCommands)
 
 
 
-// Perform collision detection. Note that unlike the preceding functions, this
-// one adds any visuals that are created directly to the main visuals list. If
-// this is multi-threaded in the future, that will need to change.
-void Engine::DoCollisions(Projectile &projectile)
+// Find everything the given projectile might hit this step. Whether those hits
+// actually happen can depend on the state of the objects hit, which may be
+// changed by other projectiles, so that is decided by DoCollisions.
+void Engine::FindCollisions(const Projectile &projectile, ProjectileHits &hits) const
 {
+	hits.collisions.clear();
+	hits.inTriggerRadius.clear();
+
+	// Projectiles that are exploding or phasing toward their target are handled
+	// entirely by DoCollisions.
+	const Weapon &weapon = projectile.GetWeapon();
+	if(projectile.ShouldExplode() || (weapon.IsPhasing() && projectile.Target()))
+		return;
+
+	double triggerRadius = weapon.TriggerRadius();
+	if(triggerRadius)
+		shipCollisions.Circle(projectile.Position(), triggerRadius, hits.inTriggerRadius);
+
 	// The asteroids can collide with projectiles, the same as any other
 	// object. If the asteroid turns out to be closer than the ship, it
 	// shields the ship (unless the projectile has a blast radius).
-	vector<Collision> collisions;
+	if(weapon.CanCollideShips())
+		shipCollisions.Line(projectile, hits.collisions);
+	if(weapon.CanCollideAsteroids())
+		asteroids.CollideAsteroids(projectile, hits.collisions);
+	if(weapon.CanCollideMinables())
+		asteroids.CollideMinables(projectile, hits.collisions);
+}
+
+
+
+// Apply the hits found by FindCollisions to the given projectile and to
+// whatever it hits.
+void Engine::DoCollisions(Projectile &projectile, ProjectileHits &hits)
+{
+	vector<Collision> &collisions = hits.collisions;
 	const Government *gov = projectile.GetGovernment();
 	const Weapon &weapon = projectile.GetWeapon();
 
@@ -2476,35 +2737,18 @@ void Engine::DoCollisions(Projectile &projectile)
 	else
 	{
 		// For weapons with a trigger radius, check if any detectable object will set it off.
-		double triggerRadius = weapon.TriggerRadius();
-		if(triggerRadius)
+		// If so, the projectile explodes instead of hitting anything along its path.
+		for(const Body *body : hits.inTriggerRadius)
 		{
-			vector<Body *> inRadius;
-			inRadius.reserve(min(static_cast<vector<Body *>::size_type>(triggerRadius), ships.size()));
-			shipCollisions.Circle(projectile.Position(), triggerRadius, inRadius);
-			for(const Body *body : inRadius)
+			const Ship *ship = static_cast<const Ship *>(body);
+			// Don't trigger off of carried ships that are disabled and not directly targeted.
+			if(body == projectile.Target() || ((!gov || gov->IsEnemy(body->GetGovernment()))
+					&& !ship->IsCloaked() && FighterHitHelper::IsValidTarget(ship)))
 			{
-				const Ship *ship = static_cast<const Ship *>(body);
-				// Don't trigger off of carried ships that are disabled and not directly targeted.
-				if(body == projectile.Target() || ((!gov || gov->IsEnemy(body->GetGovernment()))
-						&& !ship->IsCloaked() && FighterHitHelper::IsValidTarget(ship)))
-				{
-					collisions.emplace_back(nullptr, CollisionType::EXPLOSION, 0.);
-					break;
-				}
+				collisions.assign(1, Collision(nullptr, CollisionType::EXPLOSION, 0.));
+				break;
 			}
 		}
-
-		// If nothing triggered the projectile, check for collisions with ships and asteroids.
-		if(collisions.empty())
-		{
-			if(weapon.CanCollideShips())
-				shipCollisions.Line(projectile, collisions);
-			if(weapon.CanCollideAsteroids())
-				asteroids.CollideAsteroids(projectile, collisions);
-			if(weapon.CanCollideMinables())
-				asteroids.CollideMinables(projectile, collisions);
-		}
 	}
 
 	// Sort the Collisions by increasing range so that the closer collisions are evaluated first.
@@ -2792,6 +3036,8 @@ void Engine::DoScanning(const shared_ptr<Ship> &ship)
 // Fill in all the objects in the radar display.
 void Engine::FillRadar()
 {
+	Profiler::Scope scope("Engine::FillRadar");
+
 	const Ship *flagship = player.Flagship();
 	const System *playerSystem = player.GetSystem();
 
@@ -21,6 +21,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "AsteroidField.h"
 #include "shader/BatchDrawList.h"
 #include "Camera.h"
+#include "Collision.h"
 #include "CollisionSet.h"
 #include "Color.h"
 #include "Command.h"
@@ -38,6 +39,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "TaskQueue.h"
 
 #include <condition_variable>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -48,11 +50,13 @@ class Flotsam;
 class Government;
 class NPC;
 class Outfit;
+class Planet;
 class PlayerInfo;
 class Ship;
 class ShipEvent;
 class Sprite;
 class Swizzle;
+class System;
 class Visual;
 class Weather;
 
@@ -73,6 +77,9 @@ public:
 	void Place();
 	// Place NPCs spawned by a mission that offers when the player is not landed.
 	void Place(const std::list<NPC> &npcs, const std::shared_ptr<Ship> &flagship = nullptr);
+	// Add ships that were already placed in the player's system, e.g. by
+	// Fleet::Place(). The given list is emptied.
+	void Place(std::list<std::shared_ptr<Ship>> &placed);
 
 	// Wait for the previous calculations (if any) to be done.
 	void Wait();
@@ -166,6 +173,29 @@ private:
 		bool isBlind;
 	};
 
+	// Everything produced by moving ships, which is merged into the engine's lists
+	// once the ships are done moving.
+	class ShipMoveOutput {
+	public:
+		std::vector<Visual> visuals;
+		std::vector<Projectile> projectiles;
+		std::list<std::shared_ptr<Flotsam>> flotsam;
+		std::list<std::shared_ptr<Ship>> ships;
+		std::list<ShipEvent> events;
+		std::vector<Ship *> hasAntiMissile;
+		std::vector<Ship *> hasTractorBeam;
+		// Player ships that were destroyed and must no longer be selected.
+		std::vector<const Ship *> deselect;
+	};
+
+	// Everything a projectile might hit this step, found before any hits are applied.
+	class ProjectileHits {
+	public:
+		std::vector<Collision> collisions;
+		// Ships within the projectile's trigger radius, if it has one.
+		std::vector<Body *> inTriggerRadius;
+	};
+
 	class Zoom {
 	public:
 		constexpr Zoom() : base(0.) {}
@@ -180,12 +210,17 @@ private:
 
 private:
 	void EnterSystem();
+	// Begin loading the sprites of the systems that the flagship is about to travel through.
+	void PrefetchRoute(const Ship &flagship);
 
 	void CalculateStep();
 	// Calculate things that require the engine not to be paused.
 	void CalculateUnpaused(const Ship *flagship, const System *playerSystem);
 
-	void MoveShip(const std::shared_ptr<Ship> &ship);
+	void MoveShip(const std::shared_ptr<Ship> &ship, ShipMoveOutput &output);
+	// Move every ship but the flagship, spreading the work over the task queue.
+	void MoveShipsInParallel(const std::function<void(const std::shared_ptr<Ship> &, ShipMoveOutput &)> &moveShip);
+	void MergeMoveOutput(ShipMoveOutput &output);
 
 	void SpawnFleets();
 	void SpawnPersons();
@@ -197,7 +232,8 @@ private:
 
 	void FillCollisionSets();
 
-	void DoCollisions(Projectile &projectile);
+	void FindCollisions(const Projectile &projectile, ProjectileHits &hits) const;
+	void DoCollisions(Projectile &projectile, ProjectileHits &hits);
 	void DoWeather(Weather &weather);
 	void DoCollection(Flotsam &flotsam);
 	void DoScanning(const std::shared_ptr<Ship> &ship);
@@ -236,8 +272,21 @@ private:
 
 	AI ai;
 
-	TaskQueue queue;
-	TaskQueue asyncQueue;
+	// The calculation thread, which the next frame waits for.
+	TaskQueue queue{TaskQueue::Priority::HIGH};
+	// Loading of sprites that will be needed soon, which must not hold up the calculations.
+	TaskQueue asyncQueue{TaskQueue::Priority::LOW};
+	// The upcoming systems and travel destination whose sprites were last prefetched.
+	std::vector<const System *> prefetchedRoute;
+	const Planet *prefetchedDestination = nullptr;
+	// Used by the calculation thread to spread its own work over the worker threads.
+	TaskQueue workQueue{TaskQueue::Priority::HIGH};
+	// Buffers that ships write to while moving. When ships are moved in parallel, each
+	// ship gets its own buffer so the results can be merged in the same order as a
+	// serial move would have produced them.
+	std::vector<ShipMoveOutput> moveOutputs;
+	// The potential hits of each projectile, in the same order as the projectiles.
+	std::vector<ProjectileHits> projectileHits;
 
 	// ES uses a technique called double buffering to calculate the next frame and render the current one simultaneously.
 	// To facilitate this, it uses two buffers for each list of things to draw - one for the next frame's calculations and
@@ -470,6 +470,9 @@ void GameData::AddPurchase(const System &system, const string &commodity, int to
 void GameData::Change(const DataNode &node, PlayerInfo &player)
 {
 	objects.Change(node, player);
+	// The change may have altered the attitudes of governments toward each other.
+	if(node.Token(0) == "government")
+		politics.InvalidateHostility();
 }
 
 
@@ -630,6 +633,13 @@ const Set<Mission> &GameData::Missions()
 
 
 
+const MissionOfferIndex &GameData::MissionOffers()
+{
+	return objects.missionOffers;
+}
+
+
+
 const Set<News> &GameData::SpaceportNews()
 {
 	return objects.news;
@@ -49,6 +49,7 @@ class Interface;
 class MaskManager;
 class Minable;
 class Mission;
+class MissionOfferIndex;
 class News;
 class Outfit;
 class Panel;
@@ -139,6 +140,8 @@ public:
 	static const Set<Message> &Messages();
 	static const Set<Minable> &Minables();
 	static const Set<Mission> &Missions();
+	// The missions sorted by where they can be offered.
+	static const MissionOfferIndex &MissionOffers();
 	static const Set<News> &SpaceportNews();
 	static const Set<Outfit> &Outfits();
 	static const Set<Shop<Outfit>> &Outfitters();
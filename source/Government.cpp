@@ -540,6 +540,15 @@ bool Government::IsDefined() const
 
 
 
+// Get the unique index of this government. Indices are handed out in the
+// order governments are created, starting at zero.
+unsigned Government::Index() const
+{
+	return id;
+}
+
+
+
 // Get the display name of this government.
 const string &Government::DisplayName() const
 {
@@ -79,6 +79,10 @@ public:
 		const std::set<const Planet *> *visitedPlanets);
 	bool IsDefined() const;
 
+	// Get the unique index of this government. Indices are handed out in the
+	// order governments are created, starting at zero.
+	unsigned Index() const;
+
 	// Get the display name of this government.
 	const std::string &DisplayName() const;
 	// Set / Get the true name used for this government in the data files.
@@ -53,6 +53,14 @@ public:
 	bool IsEmpty() const;
 	bool IsValid() const;
 
+	// The planets, systems or governments that a match must be one of, and the
+	// sets of attributes of which it must have at least one from each. These are
+	// empty if the filter does not limit its matches in that way.
+	const std::set<const Planet *> &Planets() const;
+	const std::set<const System *> &Systems() const;
+	const std::set<const Government *> &Governments() const;
+	const std::list<std::set<std::string>> &Attributes() const;
+
 	// If the player is in the given system, does this filter match?
 	bool Matches(const Planet *planet, const System *origin = nullptr) const;
 	bool Matches(const System *system, const System *origin = nullptr) const;
@@ -49,6 +49,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Ship.h"
 #include "ShipJumpNavigation.h"
 #include "image/Sprite.h"
+#include "image/SpriteLoadManager.h"
 #include "image/SpriteSet.h"
 #include "shader/SpriteShader.h"
 #include "StellarObject.h"
@@ -239,6 +240,7 @@ MapPanel::MapPanel(PlayerInfo &player, int commodity, const System *special, boo
 	fromMission(fromMission)
 {
 	Audio::Pause();
+	SpriteLoadManager::KeepMapSprites();
 	UI::PlaySound(UI::UISound::SOFT);
 	SetIsFullScreen(true);
 	SetInterruptible(false);
@@ -281,6 +283,7 @@ MapPanel::MapPanel(PlayerInfo &player, int commodity, const System *special, boo
 MapPanel::~MapPanel()
 {
 	Audio::Resume();
+	SpriteLoadManager::ReleaseMapSprites();
 }
 
 
@@ -0,0 +1,125 @@
+/* MappedFile.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "MappedFile.h"
+
+#include "Files.h"
+
+#ifdef _WIN32
+#define STRICT
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <system_error>
+
+using namespace std;
+
+
+
+// Map the file at the given path. If the file does not exist, the contents are empty.
+MappedFile::MappedFile(const filesystem::path &path)
+{
+	// Only regular files can be mapped. Files in zips, for example, must be read
+	// through the usual file interface instead.
+	error_code error;
+	if(!filesystem::is_regular_file(path, error))
+	{
+		buffer = Files::Read(path);
+		return;
+	}
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER fileSize;
+		if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if(mapping)
+			{
+				data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+				if(data)
+					size = fileSize.QuadPart;
+				else
+				{
+					CloseHandle(mapping);
+					mapping = nullptr;
+				}
+			}
+		}
+		CloseHandle(file);
+	}
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if(file >= 0)
+	{
+		struct stat status;
+		if(!fstat(file, &status) && status.st_size > 0)
+		{
+			void *memory = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+			if(memory != MAP_FAILED)
+			{
+				data = static_cast<const char *>(memory);
+				size = status.st_size;
+				// The whole file is about to be read from start to end.
+				madvise(memory, size, MADV_SEQUENTIAL);
+			}
+		}
+		// The mapping stays valid after the file is closed.
+		close(file);
+	}
+#endif
+
+	// If mapping the file failed for any reason, fall back to reading it.
+	if(!data)
+		buffer = Files::Read(path);
+}
+
+
+
+MappedFile::~MappedFile()
+{
+	if(!data)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+	CloseHandle(mapping);
+#else
+	munmap(const_cast<char *>(data), size);
+#endif
+}
+
+
+
+// Get the contents of the file. The view stays valid as long as this object exists.
+string_view MappedFile::View() const
+{
+	return data ? string_view(data, size) : string_view(buffer);
+}
+
+
+
+bool MappedFile::IsMapped() const
+{
+	return data;
+}
@@ -0,0 +1,50 @@
+/* MappedFile.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+
+
+// A read-only view of the entire contents of a file. Regular files are mapped
+// into memory so that they can be read without copying them; files that cannot
+// be mapped, such as those inside a zipped plugin, are read into memory instead.
+class MappedFile {
+public:
+	// Map the file at the given path. If the file does not exist, the contents are empty.
+	explicit MappedFile(const std::filesystem::path &path);
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+	~MappedFile();
+
+	// Get the contents of the file. The view stays valid as long as this object exists.
+	std::string_view View() const;
+	bool IsMapped() const;
+
+
+private:
+	// The mapped memory, if the file could be mapped.
+	const char *data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void *mapping = nullptr;
+#endif
+	// The file contents, if it could not be mapped.
+	std::string buffer;
+};
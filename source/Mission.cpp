@@ -764,6 +764,20 @@ bool Mission::IsAtLocation(Location location) const
 
 
 
+const Planet *Mission::SourcePlanet() const
+{
+	return source;
+}
+
+
+
+const LocationFilter &Mission::SourceFilter() const
+{
+	return sourceFilter;
+}
+
+
+
 // Information about what you are doing.
 const Ship *Mission::SourceShip() const
 {
@@ -980,38 +994,48 @@ bool Mission::HasFullClearance() const
 
 // Check if it's possible to offer or complete this mission right now.
 bool Mission::CanOffer(const PlayerInfo &player, const shared_ptr<Ship> &boardingShip) const
+{
+	return IsAtOfferSource(player, boardingShip) && OfferConditionsMet(player)
+		&& CanDoOfferActions(player, boardingShip);
+}
+
+
+
+bool Mission::IsAtOfferSource(const PlayerInfo &player, const shared_ptr<Ship> &boardingShip) const
 {
 	if(location == BOARDING || location == ASSISTING)
 	{
 		if(!boardingShip)
 			return false;
 
-		if(!sourceFilter.Matches(*boardingShip))
-			return false;
+		return sourceFilter.Matches(*boardingShip);
 	}
-	else if(location == ENTERING || location == TRANSITION)
-	{
-		if(!sourceFilter.Matches(player.GetSystem()))
-			return false;
-	}
-	else
-	{
-		if(source && source != player.GetPlanet())
-			return false;
+	if(location == ENTERING || location == TRANSITION)
+		return sourceFilter.Matches(player.GetSystem());
+
+	if(source && source != player.GetPlanet())
+		return false;
+
+	return sourceFilter.Matches(player.GetPlanet());
+}
+
 
-		if(!sourceFilter.Matches(player.GetPlanet()))
-			return false;
-	}
 
+bool Mission::OfferConditionsMet(const PlayerInfo &player) const
+{
 	if(!toOffer.Test())
 		return false;
 
 	if(!toFail.IsEmpty() && toFail.Test())
 		return false;
 
-	if(repeat && player.Conditions().Get(trueName + ": offered") >= repeat)
-		return false;
+	return !repeat || player.Conditions().Get(trueName + ": offered") < repeat;
+}
+
+
 
+bool Mission::CanDoOfferActions(const PlayerInfo &player, const shared_ptr<Ship> &boardingShip) const
+{
 	bool isFailed = IsFailed();
 	auto it = actions.find(OFFER);
 	if(it != actions.end() && !it->second.CanBeDone(player, isFailed, boardingShip))
@@ -1034,6 +1058,17 @@ bool Mission::CanOffer(const PlayerInfo &player, const shared_ptr<Ship> &boardin
 
 
 
+set<string> Mission::OfferConditions() const
+{
+	set<string> result = toOffer.RelevantConditions();
+	result.merge(toFail.RelevantConditions());
+	if(repeat)
+		result.insert(trueName + ": offered");
+	return result;
+}
+
+
+
 bool Mission::CanAccept(const PlayerInfo &player) const
 {
 	if(!toAccept.Test())
@@ -107,6 +107,10 @@ public:
 	// Find out where this mission is offered.
 	enum Location {SPACEPORT, LANDING, JOB, ASSISTING, BOARDING, SHIPYARD, OUTFITTER, JOB_BOARD, ENTERING, TRANSITION};
 	bool IsAtLocation(Location location) const;
+	// The planet, if one is given, and the filter that the place where this
+	// mission is offered must match.
+	const Planet *SourcePlanet() const;
+	const LocationFilter &SourceFilter() const;
 
 	// Information about what you are doing.
 	const Ship *SourceShip() const;
@@ -151,6 +155,16 @@ public:
 	// into account, so before actually offering a mission you should also check
 	// if the player has enough space.
 	bool CanOffer(const PlayerInfo &player, const std::shared_ptr<Ship> &boardingShip = nullptr) const;
+	// The three parts of that check: whether the player (or the boarded ship) is
+	// where this mission is offered, whether the "to offer" and "to fail"
+	// conditions and the repeat limit allow offering it, and whether the
+	// actions of offering, accepting, declining or deferring it can be done.
+	// The second part depends on nothing but the player's conditions.
+	bool IsAtOfferSource(const PlayerInfo &player, const std::shared_ptr<Ship> &boardingShip = nullptr) const;
+	bool OfferConditionsMet(const PlayerInfo &player) const;
+	bool CanDoOfferActions(const PlayerInfo &player, const std::shared_ptr<Ship> &boardingShip = nullptr) const;
+	// Get the names of all conditions that OfferConditionsMet() reads.
+	std::set<std::string> OfferConditions() const;
 	bool CanAccept(const PlayerInfo &player) const;
 	bool HasSpace(const PlayerInfo &player) const;
 	bool HasSpace(const Ship &ship) const;
@@ -0,0 +1,69 @@
+/* MissionOfferCache.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "MissionOfferCache.h"
+
+#include "ConditionsStore.h"
+#include "Mission.h"
+#include "PlayerInfo.h"
+
+using namespace std;
+
+
+
+void MissionOfferCache::Refresh(ConditionsStore &conditions)
+{
+	const set<string> changed = conditions.TakeChanges();
+
+	// If providers were registered, any condition may now be derived or have a
+	// different value, so every mission needs to be looked at from scratch.
+	if(conditions.ProviderRevision() != providerRevision)
+	{
+		providerRevision = conditions.ProviderRevision();
+		verdicts.clear();
+		readers.clear();
+		return;
+	}
+
+	for(const string &name : changed)
+	{
+		auto it = readers.find(name);
+		if(it == readers.end())
+			continue;
+		for(const Mission *mission : it->second)
+			verdicts[mission].isKnown = false;
+	}
+}
+
+
+
+bool MissionOfferCache::OfferConditionsMet(const Mission &mission, const PlayerInfo &player)
+{
+	auto [it, isNew] = verdicts.try_emplace(&mission);
+	Verdict &verdict = it->second;
+	if(isNew)
+		for(const string &name : mission.OfferConditions())
+		{
+			verdict.readsDerived |= player.Conditions().IsDerived(name);
+			readers[name].push_back(&mission);
+		}
+
+	if(!verdict.isKnown || verdict.readsDerived)
+	{
+		verdict.isMet = mission.OfferConditionsMet(player);
+		verdict.isKnown = true;
+	}
+	return verdict.isMet;
+}
@@ -0,0 +1,59 @@
+/* MissionOfferCache.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ConditionsStore;
+class Mission;
+class PlayerInfo;
+
+
+
+// Class that remembers whether the offer conditions of each mission were met
+// the last time they were checked. Only the missions that read a condition
+// that has been set since then need to be checked again; missions that read
+// derived conditions are always checked, since their changes are not recorded.
+class MissionOfferCache {
+public:
+	// Forget the results for the missions that read any of the conditions that
+	// were set since the previous refresh. The store records these changes for
+	// only one reader, so this should be the only place that takes them.
+	void Refresh(ConditionsStore &conditions);
+	// Check if the offer conditions of the given mission are met, reusing the
+	// previous result if none of the conditions it reads has changed.
+	bool OfferConditionsMet(const Mission &mission, const PlayerInfo &player);
+
+
+private:
+	class Verdict {
+	public:
+		bool isKnown = false;
+		bool isMet = false;
+		bool readsDerived = false;
+	};
+
+
+private:
+	std::unordered_map<const Mission *, Verdict> verdicts;
+	// For each condition, the missions whose offer conditions read it.
+	std::map<std::string, std::vector<const Mission *>> readers;
+	uint64_t providerRevision = 0;
+};
@@ -0,0 +1,148 @@
+/* MissionOfferIndex.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "MissionOfferIndex.h"
+
+#include "LocationFilter.h"
+#include "Planet.h"
+#include "Ship.h"
+#include "StellarObject.h"
+#include "System.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+	// The locations where missions are offered while in flight rather than while landed.
+	const Mission::Location IN_SPACE[] = {
+		Mission::ENTERING, Mission::TRANSITION, Mission::BOARDING, Mission::ASSISTING
+	};
+}
+
+
+
+void MissionOfferIndex::Build(const Set<Mission> &missions)
+{
+	this->missions.clear();
+	landed = Buckets();
+	inSpace.clear();
+
+	for(const auto &[name, mission] : missions)
+	{
+		const size_t index = this->missions.size();
+		this->missions.push_back(&mission);
+
+		const auto location = find_if(begin(IN_SPACE), end(IN_SPACE),
+			[&mission](Mission::Location candidate) { return mission.IsAtLocation(candidate); });
+		const bool isLanded = (location == end(IN_SPACE));
+		// Ships are not matched by the attributes of the planets around them.
+		const bool isShip = !isLanded && (*location == Mission::BOARDING || *location == Mission::ASSISTING);
+		Buckets &buckets = isLanded ? landed : inSpace[*location];
+
+		// Only one requirement is needed to rule out most of the places where
+		// this mission cannot be offered; the rest is left to Mission::CanOffer().
+		const LocationFilter &filter = mission.SourceFilter();
+		if(isLanded && mission.SourcePlanet())
+			buckets.byPlanet[mission.SourcePlanet()].push_back(index);
+		else if(isLanded && !filter.Planets().empty())
+			for(const Planet *planet : filter.Planets())
+				buckets.byPlanet[planet].push_back(index);
+		else if(!filter.Systems().empty())
+			for(const System *system : filter.Systems())
+				buckets.bySystem[system].push_back(index);
+		else if(!filter.Governments().empty())
+			for(const Government *government : filter.Governments())
+				buckets.byGovernment[government].push_back(index);
+		else if(!isShip && !filter.Attributes().empty())
+			for(const string &attribute : filter.Attributes().front())
+				buckets.byAttribute[attribute].push_back(index);
+		else
+			buckets.everywhere.push_back(index);
+	}
+}
+
+
+
+vector<const Mission *> MissionOfferIndex::Candidates(const Planet *planet) const
+{
+	if(!planet)
+		return {};
+
+	return Collect(landed, planet, planet->GetSystem(), planet->GetGovernment(), {&planet->Attributes()});
+}
+
+
+
+vector<const Mission *> MissionOfferIndex::Candidates(Mission::Location location, const System *system) const
+{
+	auto it = inSpace.find(location);
+	if(!system || it == inSpace.end())
+		return {};
+
+	// A system filter matches the attributes of the system and of any of its planets.
+	vector<const set<string> *> attributes{&system->Attributes()};
+	for(const StellarObject &object : system->Objects())
+		if(object.GetPlanet())
+			attributes.push_back(&object.GetPlanet()->Attributes());
+
+	return Collect(it->second, nullptr, system, system->GetGovernment(), attributes);
+}
+
+
+
+vector<const Mission *> MissionOfferIndex::Candidates(Mission::Location location, const Ship &ship) const
+{
+	auto it = inSpace.find(location);
+	if(it == inSpace.end())
+		return {};
+
+	return Collect(it->second, nullptr, ship.GetSystem(), ship.GetGovernment(), {});
+}
+
+
+
+vector<const Mission *> MissionOfferIndex::Collect(const Buckets &buckets, const Planet *planet,
+	const System *system, const Government *government, const vector<const set<string> *> &attributes) const
+{
+	vector<size_t> indices;
+	auto add = [&indices](const auto &byKey, const auto &key) -> void
+	{
+		auto it = byKey.find(key);
+		if(it != byKey.end())
+			indices.insert(indices.end(), it->second.begin(), it->second.end());
+	};
+	add(buckets.byPlanet, planet);
+	add(buckets.bySystem, system);
+	add(buckets.byGovernment, government);
+	for(const set<string> *list : attributes)
+		for(const string &attribute : *list)
+			add(buckets.byAttribute, attribute);
+
+	// A mission may be filed under several of the attributes that were given.
+	sort(indices.begin(), indices.end());
+	indices.erase(unique(indices.begin(), indices.end()), indices.end());
+
+	// Keep the missions in the same order in which they are defined.
+	const auto middle = static_cast<ptrdiff_t>(indices.size());
+	indices.insert(indices.end(), buckets.everywhere.begin(), buckets.everywhere.end());
+	inplace_merge(indices.begin(), indices.begin() + middle, indices.end());
+
+	vector<const Mission *> result;
+	result.reserve(indices.size());
+	for(size_t index : indices)
+		result.push_back(missions[index]);
+	return result;
+}
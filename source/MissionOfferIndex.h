@@ -0,0 +1,80 @@
+/* MissionOfferIndex.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Mission.h"
+#include "Set.h"
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+class Government;
+class Planet;
+class Ship;
+class System;
+
+
+
+// Class that sorts the missions by where they can be offered, so that only the
+// missions that might be offered in a given place need to be checked there.
+// Every mission is filed under one thing that its source must be or have: the
+// source planet, or one of the planets, systems, governments or attributes that
+// its source filter requires. Missions without any such requirement are always
+// candidates. The planets, systems and ships are examined when the candidates
+// are requested, so later changes to their governments or attributes are taken
+// into account, but the index must be built again if the missions change.
+class MissionOfferIndex {
+public:
+	void Build(const Set<Mission> &missions);
+
+	// Get the missions that might be offered while landed on the given planet,
+	// at any of the locations on it, in the same order as GameData::Missions().
+	std::vector<const Mission *> Candidates(const Planet *planet) const;
+	// Get the missions that might be offered when entering or transitioning
+	// into the given system.
+	std::vector<const Mission *> Candidates(Mission::Location location, const System *system) const;
+	// Get the missions that might be offered when boarding or assisting the given ship.
+	std::vector<const Mission *> Candidates(Mission::Location location, const Ship &ship) const;
+
+
+private:
+	// The missions that might be offered at one kind of location, as indices
+	// into the list of all missions.
+	class Buckets {
+	public:
+		std::vector<size_t> everywhere;
+		std::map<const Planet *, std::vector<size_t>> byPlanet;
+		std::map<const System *, std::vector<size_t>> bySystem;
+		std::map<const Government *, std::vector<size_t>> byGovernment;
+		std::map<std::string, std::vector<size_t>> byAttribute;
+	};
+
+
+private:
+	// Combine the missions filed under any of the given keys with the ones that
+	// are always candidates.
+	std::vector<const Mission *> Collect(const Buckets &buckets, const Planet *planet, const System *system,
+		const Government *government, const std::vector<const std::set<std::string> *> &attributes) const;
+
+
+private:
+	std::vector<const Mission *> missions;
+	Buckets landed;
+	std::map<Mission::Location, Buckets> inSpace;
+};
@@ -571,9 +571,10 @@ bool Planet::HasShipyard() const
 
 
 // Get the list of ships in the permanent shipyard.
-const Sale<Ship> &Planet::ShipyardStock() const
+Sale<Ship> Planet::ShipyardStock() const
 {
-	shipyard.clear();
+	// This is built anew each time so that it can be asked for by several threads at once.
+	Sale<Ship> shipyard;
 	for(const Shop<Ship> *sale : shipSales)
 		shipyard.Add(sale->Stock());
 
@@ -604,9 +605,10 @@ bool Planet::HasOutfitter() const
 
 
 // Get the list of outfits available from the permanent outfitter.
-const Sale<Outfit> &Planet::OutfitterStock() const
+Sale<Outfit> Planet::OutfitterStock() const
 {
-	outfitter.clear();
+	// This is built anew each time so that it can be asked for by several threads at once.
+	Sale<Outfit> outfitter;
 	for(const Shop<Outfit> *sale : outfitSales)
 		outfitter.Add(sale->Stock());
 
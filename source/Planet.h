@@ -107,7 +107,7 @@ public:
 	// Check if this planet has a permanent shipyard.
 	bool HasShipyard() const;
 	// Get the list of ships in the permanent shipyard.
-	const Sale<Ship> &ShipyardStock() const;
+	Sale<Ship> ShipyardStock() const;
 	// Get the list of shipyards currently available on this planet.
 	// This will include conditionally available shops.
 	std::set<const Shop<Ship> *> Shipyards() const;
@@ -115,7 +115,7 @@ public:
 	// Check if this planet has a permanent outfitter.
 	bool HasOutfitter() const;
 	// Get the list of outfits available from the permanent outfitter.
-	const Sale<Outfit> &OutfitterStock() const;
+	Sale<Outfit> OutfitterStock() const;
 	// Get the list of outitters available on this planet.
 	// This will include conditionally available shops.
 	std::set<const Shop<Outfit> *> Outfitters() const;
@@ -193,10 +193,6 @@ private:
 
 	std::set<const Shop<Ship> *> shipSales;
 	std::set<const Shop<Outfit> *> outfitSales;
-	// The lists above will be converted into actual ship lists when they are
-	// first asked for:
-	mutable Sale<Ship> shipyard;
-	mutable Sale<Outfit> outfitter;
 
 	const Government *government = nullptr;
 	double requiredReputation = 0.;
@@ -32,6 +32,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Government.h"
 #include "Logger.h"
 #include "Messages.h"
+#include "MissionOfferIndex.h"
 #include "Outfit.h"
 #include "Person.h"
 #include "PilotProfile.h"
@@ -51,6 +52,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "StartConditions.h"
 #include "StellarObject.h"
 #include "System.h"
+#include "TaskQueue.h"
 #include "UI.h"
 #include "Weapon.h"
 
@@ -2540,10 +2542,11 @@ Mission *PlayerInfo::BoardingMission(const shared_ptr<Ship> &ship)
 			? Mission::BOARDING : Mission::ASSISTING);
 
 	// Check for available boarding or assisting missions.
-	for(const auto &[name, mission] : GameData::Missions())
-		if(mission.IsAtLocation(location) && mission.CanOffer(*this, ship))
+	offerCache.Refresh(conditions);
+	for(const Mission *mission : GameData::MissionOffers().Candidates(location, *ship))
+		if(CanOffer(*mission, ship))
 		{
-			availableBoardingMissions.push_back(mission.Instantiate(*this, ship));
+			availableBoardingMissions.push_back(mission->Instantiate(*this, ship));
 			if(availableBoardingMissions.back().IsFailed())
 				availableBoardingMissions.pop_back();
 			else
@@ -2561,10 +2564,11 @@ void PlayerInfo::CreateEnteringMissions()
 
 	bool hasPriorityMissions = false;
 	unsigned nonBlockingMissions = 0;
-	for(const auto &[name, mission] : GameData::Missions())
-		if(mission.IsAtLocation(Mission::ENTERING) && mission.CanOffer(*this))
+	offerCache.Refresh(conditions);
+	for(const Mission *mission : GameData::MissionOffers().Candidates(Mission::ENTERING, system))
+		if(CanOffer(*mission))
 		{
-			availableEnteringMissions.push_back(mission.Instantiate(*this));
+			availableEnteringMissions.push_back(mission->Instantiate(*this));
 			if(availableEnteringMissions.back().IsFailed())
 				availableEnteringMissions.pop_back();
 			else
@@ -2585,10 +2589,11 @@ void PlayerInfo::CreateTransitionMissions()
 
 	bool hasPriorityMissions = false;
 	unsigned nonBlockingMissions = 0;
-	for(const auto &[name, mission] : GameData::Missions())
-		if(mission.IsAtLocation(Mission::TRANSITION) && mission.CanOffer(*this))
+	offerCache.Refresh(conditions);
+	for(const Mission *mission : GameData::MissionOffers().Candidates(Mission::TRANSITION, system))
+		if(CanOffer(*mission))
 		{
-			availableTransitionMissions.push_back(mission.Instantiate(*this));
+			availableTransitionMissions.push_back(mission->Instantiate(*this));
 			if(availableTransitionMissions.back().IsFailed())
 				availableTransitionMissions.pop_back();
 			else
@@ -4774,30 +4779,50 @@ void PlayerInfo::CreateMissions()
 	bool skipJobs = planet && !planet->GetPort().HasService(Port::ServicesType::JobBoard);
 	bool hasPriorityMissions = false;
 	unsigned nonBlockingMissions = 0;
-	for(const auto &[name, mission] : GameData::Missions())
+	offerCache.Refresh(conditions);
+	vector<const Mission *> offered;
+	for(const Mission *mission : GameData::MissionOffers().Candidates(planet))
+		if(!(skipJobs && mission->IsAtLocation(Mission::JOB)) && CanOffer(*mission))
+			offered.push_back(mission);
+
+	// Instantiate the offered missions in parallel. Each mission draws its random
+	// numbers from its own stream, seeded in the order of the missions, so that
+	// the results do not depend on which thread instantiates which mission.
+	vector<uint64_t> seeds;
+	seeds.reserve(offered.size());
+	for(size_t i = 0; i < offered.size(); ++i)
+		seeds.push_back((static_cast<uint64_t>(Random::Int()) << 32) | Random::Int());
+	// The flagship, and the text and day number of the date, are worked out the
+	// first time they are asked for and then cached. Fill those caches now, so
+	// that the tasks below only ever read them.
+	FlagshipPtr();
+	date.ToString();
+	date.DaysSinceEpoch();
+	vector<Mission> instances(offered.size());
+	TaskQueue queue(TaskQueue::Priority::HIGH);
+	queue.ParallelFor(offered.size(), 1, [this, &offered, &seeds, &instances](size_t begin, size_t end)
 	{
-		if(mission.IsAtLocation(Mission::BOARDING) || mission.IsAtLocation(Mission::ASSISTING)
-				|| mission.IsAtLocation(Mission::ENTERING) || mission.IsAtLocation(Mission::TRANSITION))
-			continue;
-		if(skipJobs && mission.IsAtLocation(Mission::JOB))
-			continue;
-
-		if(mission.CanOffer(*this))
+		for(size_t i = begin; i < end; ++i)
 		{
-			list<Mission> &missions =
-				mission.IsAtLocation(Mission::JOB) ? availableJobs : availableMissions;
+			Random::Stream stream(seeds[i]);
+			instances[i] = offered[i]->Instantiate(*this);
+		}
+	});
 
-			Mission newMission = mission.Instantiate(*this);
-			if(newMission.IsFailed())
-				continue;
-			newMission.RecalculateTrackedSystems();
-			if(!mission.IsAtLocation(Mission::JOB))
-			{
-				hasPriorityMissions |= newMission.HasPriority();
-				nonBlockingMissions += newMission.IsNonBlocking();
-			}
-			missions.push_back(std::move(newMission));
+	// Add the missions in the order in which they would have been instantiated serially.
+	for(size_t i = 0; i < offered.size(); ++i)
+	{
+		Mission &newMission = instances[i];
+		if(newMission.IsFailed())
+			continue;
+		newMission.RecalculateTrackedSystems();
+		const bool isJob = offered[i]->IsAtLocation(Mission::JOB);
+		if(!isJob)
+		{
+			hasPriorityMissions |= newMission.HasPriority();
+			nonBlockingMissions += newMission.IsNonBlocking();
 		}
+		(isJob ? availableJobs : availableMissions).push_back(std::move(newMission));
 	}
 
 	SortMissions(availableMissions, hasPriorityMissions, nonBlockingMissions);
@@ -4805,6 +4830,14 @@ void PlayerInfo::CreateMissions()
 
 
 
+bool PlayerInfo::CanOffer(const Mission &mission, const shared_ptr<Ship> &boardingShip)
+{
+	return mission.IsAtOfferSource(*this, boardingShip) && offerCache.OfferConditionsMet(mission, *this)
+		&& mission.CanDoOfferActions(*this, boardingShip);
+}
+
+
+
 // Updates each mission upon landing, to perform landing actions (Stopover,
 // Visit, Complete, Fail), and remove now-complete or now-failed missions.
 void PlayerInfo::StepMissions(UI &ui)
@@ -28,6 +28,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "GameEvent.h"
 #include "Minable.h"
 #include "Mission.h"
+#include "MissionOfferCache.h"
 #include "SystemEntry.h"
 
 #include <chrono>
@@ -439,6 +440,8 @@ private:
 
 	// New missions are generated each time you land on a planet.
 	void CreateMissions();
+	// Check if the given mission can be offered, reusing the result of its offer conditions if possible.
+	bool CanOffer(const Mission &mission, const std::shared_ptr<Ship> &boardingShip = nullptr);
 	void StepMissions(UI &ui);
 	void Autosave() const;
 	void Save(const std::string &path) const;
@@ -559,6 +562,8 @@ private:
 	bool sortSeparatePossible = false;
 
 	ConditionsStore conditions;
+	// Whether the offer conditions of each mission were met when they were last checked.
+	MissionOfferCache offerCache;
 	std::map<std::string, EsUuid> giftedShips;
 
 	std::set<const System *> seen;
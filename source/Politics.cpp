@@ -70,6 +70,9 @@ void Politics::Reset()
 	// were already checked for when you first landed).
 	for(const auto &it : GameData::Governments())
 		fined.insert(&it.second);
+
+	// The governments themselves may have been reverted, too.
+	InvalidateHostility();
 }
 
 
@@ -79,27 +82,27 @@ bool Politics::IsEnemy(const Government *first, const Government *second) const
 	if(!first || !second)
 		return false;
 
-	if(first == second)
-		return false;
+	if(!hostilityIsValid.load(memory_order_acquire))
+		UpdateHostility();
 
-	// Just for simplicity, if one of the governments is the player, make sure
-	// it is the first one.
-	if(second->IsPlayer())
-		swap(first, second);
-	if(first->IsPlayer())
-	{
-		if(bribed.contains(second))
-			return false;
-		if(provoked.contains(second))
-			return true;
+	// Governments that were created after the cache was built (or that are not
+	// part of the game data) are not in it.
+	const size_t a = first->Index();
+	const size_t b = second->Index();
+	if(a < hostilityGovernments.size() && b < hostilityGovernments.size()
+			&& hostilityGovernments[a] == first && hostilityGovernments[b] == second)
+		return (hostility[a * hostilityStride + b / 64] >> (b % 64)) & 1;
 
-		auto it = reputationWith.find(second);
-		return (it != reputationWith.end() && it->second < 0.);
-	}
+	return FindIsEnemy(first, second);
+}
 
-	// Neither government is the player, so the question of enemies depends only
-	// on the attitude matrix.
-	return (first->AttitudeToward(second) < 0. || second->AttitudeToward(first) < 0.);
+
+
+// Let the hostility cache know that the attitudes of the governments toward
+// each other may have changed.
+void Politics::InvalidateHostility()
+{
+	hostilityIsValid.store(false, memory_order_release);
 }
 
 
@@ -132,6 +135,7 @@ void Politics::Offend(const Government *gov, int eventType, int count)
 				// your bribe is canceled out.
 				bribed.erase(other);
 				provoked.insert(other);
+				UpdatePlayerHostility(other);
 			}
 		}
 		if(count && abs(weight) >= .05)
@@ -157,6 +161,7 @@ void Politics::Bribe(const Government *gov)
 	bribed.insert(gov);
 	provoked.erase(gov);
 	fined.insert(gov);
+	UpdatePlayerHostility(gov);
 }
 
 
@@ -426,6 +431,7 @@ void Politics::SetReputation(const Government *gov, double value)
 	value = min(value, gov->ReputationMax());
 	value = max(value, gov->ReputationMin());
 	reputationWith[gov] = value;
+	UpdatePlayerHostility(gov);
 }
 
 
@@ -437,4 +443,94 @@ void Politics::ResetDaily()
 	bribed.clear();
 	bribedPlanets.clear();
 	fined.clear();
+	InvalidateHostility();
+}
+
+
+
+// Work out whether the two governments are enemies, without using the cache.
+bool Politics::FindIsEnemy(const Government *first, const Government *second) const
+{
+	if(first == second)
+		return false;
+
+	// Just for simplicity, if one of the governments is the player, make sure
+	// it is the first one.
+	if(second->IsPlayer())
+		swap(first, second);
+	if(first->IsPlayer())
+	{
+		if(bribed.contains(second))
+			return false;
+		if(provoked.contains(second))
+			return true;
+
+		auto it = reputationWith.find(second);
+		return (it != reputationWith.end() && it->second < 0.);
+	}
+
+	// Neither government is the player, so the question of enemies depends only
+	// on the attitude matrix.
+	return (first->AttitudeToward(second) < 0. || second->AttitudeToward(first) < 0.);
+}
+
+
+
+// Rebuild the hostility cache for all governments, if it is out of date.
+void Politics::UpdateHostility() const
+{
+	lock_guard<mutex> lock(hostilityMutex);
+	// Another thread may have rebuilt the cache while this one was waiting.
+	if(hostilityIsValid.load(memory_order_relaxed))
+		return;
+
+	hostilityGovernments.clear();
+	for(const auto &it : GameData::Governments())
+	{
+		const Government *gov = &it.second;
+		if(hostilityGovernments.size() <= gov->Index())
+			hostilityGovernments.resize(gov->Index() + 1, nullptr);
+		hostilityGovernments[gov->Index()] = gov;
+	}
+
+	const size_t count = hostilityGovernments.size();
+	hostilityStride = (count + 63) / 64;
+	hostility.assign(count * hostilityStride, 0);
+	for(size_t a = 0; a < count; ++a)
+		for(size_t b = 0; b < count; ++b)
+			if(hostilityGovernments[a] && hostilityGovernments[b]
+					&& FindIsEnemy(hostilityGovernments[a], hostilityGovernments[b]))
+				hostility[a * hostilityStride + b / 64] |= uint64_t(1) << (b % 64);
+
+	hostilityIsValid.store(true, memory_order_release);
+}
+
+
+
+// Update the cached hostility between the player and the given government,
+// after the player's relationship with it has changed.
+void Politics::UpdatePlayerHostility(const Government *gov)
+{
+	// If the cache is out of date, it will be rebuilt in full anyway.
+	if(!gov || !hostilityIsValid.load(memory_order_acquire))
+		return;
+
+	const Government *player = GameData::PlayerGovernment();
+	if(!player)
+		return;
+	const size_t a = player->Index();
+	const size_t b = gov->Index();
+	if(a >= hostilityGovernments.size() || b >= hostilityGovernments.size()
+			|| hostilityGovernments[a] != player || hostilityGovernments[b] != gov)
+		return;
+
+	const bool isEnemy = FindIsEnemy(player, gov);
+	auto update = [this, isEnemy](size_t row, size_t column) noexcept -> void
+	{
+		uint64_t &word = hostility[row * hostilityStride + column / 64];
+		const uint64_t bit = uint64_t(1) << (column % 64);
+		word = isEnemy ? (word | bit) : (word & ~bit);
+	};
+	update(a, b);
+	update(b, a);
 }
@@ -15,9 +15,13 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 class Conversation;
 class Government;
@@ -37,6 +41,9 @@ public:
 	void Reset();
 
 	bool IsEnemy(const Government *first, const Government *second) const;
+	// Let the hostility cache know that the attitudes of the governments toward
+	// each other may have changed.
+	void InvalidateHostility();
 
 	// Commit the given "offense" against the given government (which may not
 	// actually consider it to be an offense). This may result in temporary
@@ -73,6 +80,16 @@ public:
 	void ResetDaily();
 
 
+private:
+	// Work out whether the two governments are enemies, without using the cache.
+	bool FindIsEnemy(const Government *first, const Government *second) const;
+	// Rebuild the hostility cache for all governments, if it is out of date.
+	void UpdateHostility() const;
+	// Update the cached hostility between the player and the given government,
+	// after the player's relationship with it has changed.
+	void UpdatePlayerHostility(const Government *gov);
+
+
 private:
 	// attitude[target][other] stores how much an action toward the given target
 	// government will affect your reputation with the given other government.
@@ -85,4 +102,15 @@ private:
 	std::map<const Planet *, bool> bribedPlanets;
 	std::set<const Planet *> dominatedPlanets;
 	std::set<const Government *> fined;
+
+	// A cache of which governments are enemies of each other. Bit (second index)
+	// of row (first index) is set if the governments are hostile. The cache may
+	// be rebuilt from any thread, but any change to the political state that it
+	// depends on must happen while no other thread is checking for enemies.
+	mutable std::vector<uint64_t> hostility;
+	// The governments in the cache, by index, and the number of words per row.
+	mutable std::vector<const Government *> hostilityGovernments;
+	mutable size_t hostilityStride = 0;
+	mutable std::atomic<bool> hostilityIsValid = false;
+	mutable std::mutex hostilityMutex;
 };
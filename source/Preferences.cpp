@@ -182,6 +182,11 @@ namespace {
 	const vector<string> LARGE_GRAPHICS_REDUCTION_SETTINGS = {"off", "largest only", "all"};
 	int largeGraphicsReductionIndex = 0;
 
+	// The number of megabytes that images using deferred loading may take up, with 0 meaning no limit.
+	const vector<string> IMAGE_MEMORY_LIMIT_SETTINGS = {"unlimited", "256 MB", "512 MB", "1 GB", "2 GB"};
+	const vector<size_t> IMAGE_MEMORY_LIMIT_MEGABYTES = {0, 256, 512, 1024, 2048};
+	int imageMemoryLimitIndex = 0;
+
 	const vector<string> TRIBUTE_CONFIRMATION_SETTINGS = {"off", "friendly only", "always"};
 	int tributeConfirmationIndex = 1;
 
@@ -299,6 +304,8 @@ void Preferences::Load()
 			flagshipSpacePriorityIndex = clamp<int>(node.Value(1), 0, FLAGSHIP_SPACE_PRIORITY_SETTINGS.size() - 1);
 		else if(key == "Reduce large graphics")
 			largeGraphicsReductionIndex = clamp<int>(node.Value(1), 0, LARGE_GRAPHICS_REDUCTION_SETTINGS.size() - 1);
+		else if(key == "Deferred image memory")
+			imageMemoryLimitIndex = clamp<int>(node.Value(1), 0, IMAGE_MEMORY_LIMIT_SETTINGS.size() - 1);
 		else if(key == "previous saves" && hasValue)
 			previousSaveCount = max<int>(3, node.Value(1));
 		else if(key == "alt-mouse turning")
@@ -419,6 +426,7 @@ void Preferences::Save()
 	out.Write("Show mini-map", minimapDisplayIndex);
 	out.Write("Prioritize flagship use", flagshipSpacePriorityIndex);
 	out.Write("Reduce large graphics", largeGraphicsReductionIndex);
+	out.Write("Deferred image memory", imageMemoryLimitIndex);
 	out.Write("Tribute confirmation", tributeConfirmationIndex);
 	out.Write("Ammo refill", ammoRefillIndex);
 	out.Write("Text alignment", textAlignmentIndex);
@@ -1026,6 +1034,28 @@ const string &Preferences::LargeGraphicsReductionSetting()
 
 
 
+void Preferences::ToggleImageMemoryLimit()
+{
+	if(++imageMemoryLimitIndex >= static_cast<int>(IMAGE_MEMORY_LIMIT_SETTINGS.size()))
+		imageMemoryLimitIndex = 0;
+}
+
+
+
+size_t Preferences::ImageMemoryLimit()
+{
+	return IMAGE_MEMORY_LIMIT_MEGABYTES[imageMemoryLimitIndex] << 20;
+}
+
+
+
+const string &Preferences::ImageMemoryLimitSetting()
+{
+	return IMAGE_MEMORY_LIMIT_SETTINGS[imageMemoryLimitIndex];
+}
+
+
+
 void Preferences::ToggleTributeConfirmation()
 {
 	if(++tributeConfirmationIndex >= static_cast<int>(TRIBUTE_CONFIRMATION_SETTINGS.size()))
@@ -15,6 +15,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -291,6 +292,11 @@ public:
 	static LargeGraphicsReduction GetLargeGraphicsReduction();
 	static const std::string &LargeGraphicsReductionSetting();
 
+	/// Video memory limit for images that use deferred loading, in bytes. 0 means there is no limit.
+	static void ToggleImageMemoryLimit();
+	static size_t ImageMemoryLimit();
+	static const std::string &ImageMemoryLimitSetting();
+
 	/// Tribute confirmation dialog setting.
 	static void ToggleTributeConfirmation();
 	static TributeConfirmation GetTributeConfirmation();
@@ -66,6 +66,7 @@ namespace {
 	const string VSYNC_SETTING = "VSync";
 	const string CAMERA_ACCELERATION = "Camera acceleration";
 	const string LARGE_GRAPHICS_REDUCTION = "Reduce large graphics";
+	const string IMAGE_MEMORY_LIMIT = "Deferred image memory";
 	const string CLOAK_OUTLINE = "Cloaked ship outlines";
 	const string TEXTURE_FILTERING = "Texture filtering";
 	const string STATUS_OVERLAYS_ALL = "Show status overlays";
@@ -778,6 +779,10 @@ void PreferencesPanel::DrawSettings()
 		"Show CPU / GPU load",
 		LARGE_GRAPHICS_REDUCTION,
 		"Defer loading images",
+		IMAGE_MEMORY_LIMIT,
+		"Cache decoded images",
+		"Parallel ship movement",
+		"Parallel AI",
 		SHIP_OUTLINES,
 		HUD_SHIP_OUTLINES,
 		"",
@@ -939,6 +944,11 @@ void PreferencesPanel::DrawSettings()
 			text = Preferences::LargeGraphicsReductionSetting();
 			isOn = text != "off";
 		}
+		else if(setting == IMAGE_MEMORY_LIMIT)
+		{
+			text = Preferences::ImageMemoryLimitSetting();
+			isOn = text != "unlimited";
+		}
 		else if(setting == STATUS_OVERLAYS_FLAGSHIP)
 		{
 			text = Preferences::StatusOverlaysSetting(Preferences::OverlayType::FLAGSHIP);
@@ -1427,6 +1437,8 @@ void PreferencesPanel::HandleSettingsString(const string &str, Point cursorPosit
 		Preferences::ToggleCameraAcceleration();
 	else if(str == LARGE_GRAPHICS_REDUCTION)
 		Preferences::ToggleLargeGraphicsReduction();
+	else if(str == IMAGE_MEMORY_LIMIT)
+		Preferences::ToggleImageMemoryLimit();
 	else if(str == STATUS_OVERLAYS_ALL)
 		Preferences::CycleStatusOverlays(Preferences::OverlayType::ALL);
 	else if(str == STATUS_OVERLAYS_FLAGSHIP)
@@ -0,0 +1,192 @@
+/* Profiler.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// The number of events each thread keeps. At 60 frames per second and
+	// about a dozen events per frame, this covers well over a minute.
+	constexpr size_t BUFFER_SIZE = 1 << 16;
+
+	class Event {
+	public:
+		const char *name;
+		int64_t start;
+		int64_t duration;
+	};
+
+	// The events of one thread. Only that thread writes to it; the count is only
+	// increased once an event has been written completely, so that a reader can
+	// tell which events it may read.
+	class Buffer {
+	public:
+		explicit Buffer(unsigned thread) : thread(thread) {}
+
+		unsigned thread;
+		atomic<uint64_t> count = 0;
+		array<Event, BUFFER_SIZE> events;
+		// How many of the events TakeTotals has counted. Only read and written
+		// while holding the lock on the buffers.
+		uint64_t taken = 0;
+	};
+
+	atomic<bool> isEnabled = false;
+
+	// The buffers of all threads that have ever recorded an event. A thread's
+	// buffer is kept after it exits, so that its events can still be written.
+	mutex buffersMutex;
+	vector<unique_ptr<Buffer>> buffers;
+
+	// Get the time in nanoseconds since the program started.
+	int64_t Now()
+	{
+		static const chrono::steady_clock::time_point START = chrono::steady_clock::now();
+		return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - START).count();
+	}
+
+	// Get this thread's buffer, creating it if it does not exist yet. This
+	// only needs the lock the first time a thread records anything.
+	Buffer &ThreadBuffer()
+	{
+		thread_local Buffer *buffer = nullptr;
+		if(!buffer)
+		{
+			lock_guard<mutex> lock(buffersMutex);
+			buffers.emplace_back(make_unique<Buffer>(buffers.size() + 1));
+			buffer = buffers.back().get();
+		}
+		return *buffer;
+	}
+
+	// Copy the events of the given buffer from the given index on, leaving out
+	// the ones the thread may have overwritten while they were being copied.
+	// The index is moved past the last event that was copied.
+	vector<Event> CopyEvents(const Buffer &buffer, uint64_t &from)
+	{
+		// Copy the events first, and then check which of them the thread may
+		// have overwritten in the meantime, including the one it may be writing
+		// right now. Those are dropped.
+		uint64_t end = buffer.count.load(memory_order_acquire);
+		uint64_t begin = max(from, end - min<uint64_t>(end, BUFFER_SIZE));
+		vector<Event> events;
+		for(uint64_t i = begin; i < end; ++i)
+			events.push_back(buffer.events[i % BUFFER_SIZE]);
+		uint64_t written = buffer.count.load(memory_order_acquire) + 1;
+		uint64_t overwritten = written > BUFFER_SIZE ? written - BUFFER_SIZE : 0;
+		size_t skip = overwritten > begin ? min<uint64_t>(events.size(), overwritten - begin) : 0;
+		events.erase(events.begin(), events.begin() + skip);
+		from = end;
+		return events;
+	}
+
+	// Write the given number of nanoseconds as microseconds, the unit of trace events.
+	void WriteMicroseconds(ostream &out, int64_t nanoseconds)
+	{
+		out << nanoseconds / 1000 << '.';
+		int64_t fraction = nanoseconds % 1000;
+		out << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + fraction / 10 % 10)
+			<< static_cast<char>('0' + fraction % 10);
+	}
+}
+
+
+
+Profiler::Scope::Scope(const char *name)
+	: name(name), start(isEnabled.load(memory_order_relaxed) ? Now() : -1)
+{
+}
+
+
+
+Profiler::Scope::~Scope()
+{
+	if(start < 0)
+		return;
+
+	Buffer &buffer = ThreadBuffer();
+	uint64_t count = buffer.count.load(memory_order_relaxed);
+	buffer.events[count % BUFFER_SIZE] = Event{name, start, Now() - start};
+	buffer.count.store(count + 1, memory_order_release);
+}
+
+
+
+// Turn recording on or off. Recording is off by default, and then scopes
+// cost no more than a check of this flag.
+void Profiler::SetEnabled(bool enabled)
+{
+	isEnabled.store(enabled, memory_order_relaxed);
+}
+
+
+
+bool Profiler::IsEnabled()
+{
+	return isEnabled.load(memory_order_relaxed);
+}
+
+
+
+// Write all the events that are still in the ring buffers as a JSON trace.
+// This may be called while other threads are recording.
+void Profiler::WriteTrace(ostream &out)
+{
+	lock_guard<mutex> lock(buffersMutex);
+
+	out << "{\"traceEvents\":[";
+	bool first = true;
+	for(const unique_ptr<Buffer> &buffer : buffers)
+	{
+		uint64_t from = 0;
+		for(const Event &event : CopyEvents(*buffer, from))
+		{
+			out << (first ? "\n" : ",\n");
+			first = false;
+			// The names are string literals in the code, so they need no escaping.
+			out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread
+				<< ",\"ts\":";
+			WriteMicroseconds(out, event.start);
+			out << ",\"dur\":";
+			WriteMicroseconds(out, event.duration);
+			out << '}';
+		}
+	}
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+
+
+// Get the total time in milliseconds that was spent in each phase, over all
+// threads, counting only the events recorded since the last call.
+map<string, double> Profiler::TakeTotals()
+{
+	lock_guard<mutex> lock(buffersMutex);
+
+	map<string, double> totals;
+	for(const unique_ptr<Buffer> &buffer : buffers)
+		for(const Event &event : CopyEvents(*buffer, buffer->taken))
+			totals[event.name] += event.duration / 1e6;
+	return totals;
+}
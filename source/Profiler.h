@@ -0,0 +1,60 @@
+/* Profiler.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+
+
+// The Profiler records how long the phases of each frame take, so that it is
+// possible to see which phase took too long on a given frame. Each thread
+// records into its own ring buffer, which only holds the most recent events,
+// so recording never takes a lock. The recorded events can be written out in
+// the trace event format that Chrome's about:tracing and Perfetto can show.
+class Profiler {
+public:
+	// Object that records the time from its creation until its destruction as
+	// one event with the given name. The name must be a string literal.
+	class Scope {
+	public:
+		explicit Scope(const char *name);
+		~Scope();
+
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+
+	private:
+		const char *name;
+		int64_t start;
+	};
+
+
+public:
+	// Turn recording on or off. Recording is off by default, and then scopes
+	// cost no more than a check of this flag.
+	static void SetEnabled(bool enabled);
+	static bool IsEnabled();
+
+	// Write all the events that are still in the ring buffers as a JSON trace.
+	// This may be called while other threads are recording.
+	static void WriteTrace(std::ostream &out);
+	// Get the total time in milliseconds that was spent in each phase, over all
+	// threads, counting only the events recorded since the last call.
+	static std::map<std::string, double> TakeTotals();
+};
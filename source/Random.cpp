@@ -23,23 +23,42 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 using namespace std;
 
-// Right now thread_local storage is only supported under Linux.
-namespace {
-#ifndef __linux__
-	mutex workaroundMutex;
+class Random::Generator {
+public:
 	mt19937_64 gen;
 	uniform_int_distribution<uint32_t> uniform;
 	uniform_real_distribution<double> real;
 	normal_distribution<double> normal;
+};
+
+
+
+// Right now thread_local storage is only supported under Linux.
+namespace {
+#ifndef __linux__
+	mutex workaroundMutex;
+	Random::Generator shared;
 #else
-	thread_local mt19937_64 gen;
-	thread_local uniform_int_distribution<uint32_t> uniform;
-	thread_local uniform_real_distribution<double> real;
-	thread_local normal_distribution<double> normal;
+	thread_local Random::Generator shared;
 #endif
 
+	// The generator of the stream that is active on this thread, if any.
+	thread_local Random::Generator *stream = nullptr;
+
 	bool useFixedSeed = false;
 	uint64_t fixedSeed = 0;
+
+	// Call the given function with the generator that this thread should draw from.
+	template<class Function>
+	auto Generate(Function &&function)
+	{
+		if(stream)
+			return function(*stream);
+#ifndef __linux__
+		lock_guard<mutex> lock(workaroundMutex);
+#endif
+		return function(shared);
+	}
 }
 
 
@@ -51,7 +70,7 @@ void Random::Seed(uint64_t seed)
 #ifndef __linux__
 	lock_guard<mutex> lock(workaroundMutex);
 #endif
-	gen.seed(useFixedSeed ? fixedSeed : seed);
+	shared.gen.seed(useFixedSeed ? fixedSeed : seed);
 }
 
 
@@ -66,20 +85,14 @@ void Random::SetFixedSeed(uint64_t seed)
 
 uint32_t Random::Int()
 {
-#ifndef __linux__
-	lock_guard<mutex> lock(workaroundMutex);
-#endif
-	return uniform(gen);
+	return Generate([](Generator &generator) { return generator.uniform(generator.gen); });
 }
 
 
 
 uint32_t Random::Int(uint32_t upper_bound)
 {
-#ifndef __linux__
-	lock_guard<mutex> lock(workaroundMutex);
-#endif
-	const uint32_t x = uniform(gen);
+	const uint32_t x = Int();
 	return (static_cast<uint64_t>(x) * static_cast<uint64_t>(upper_bound)) >> 32;
 }
 
@@ -87,10 +100,7 @@ uint32_t Random::Int(uint32_t upper_bound)
 
 double Random::Real()
 {
-#ifndef __linux__
-	lock_guard<mutex> lock(workaroundMutex);
-#endif
-	return real(gen);
+	return Generate([](Generator &generator) { return generator.real(generator.gen); });
 }
 
 
@@ -100,10 +110,7 @@ double Random::Real()
 uint32_t Random::Polya(uint32_t k, double p)
 {
 	negative_binomial_distribution<uint32_t> polya(k, p);
-#ifndef __linux__
-	lock_guard<mutex> lock(workaroundMutex);
-#endif
-	return polya(gen);
+	return Generate([&polya](Generator &generator) { return polya(generator.gen); });
 }
 
 
@@ -112,10 +119,7 @@ uint32_t Random::Polya(uint32_t k, double p)
 uint32_t Random::Binomial(uint32_t t, double p)
 {
 	binomial_distribution<uint32_t> binomial(t, p);
-#ifndef __linux__
-	lock_guard<mutex> lock(workaroundMutex);
-#endif
-	return binomial(gen);
+	return Generate([&binomial](Generator &generator) { return binomial(generator.gen); });
 }
 
 
@@ -123,8 +127,21 @@ uint32_t Random::Binomial(uint32_t t, double p)
 // Get a normally distributed number with standard or specified mean and stddev.
 double Random::Normal(double mean, double sigma)
 {
-#ifndef __linux__
-	lock_guard<mutex> lock(workaroundMutex);
-#endif
-	return sigma * normal(gen) + mean;
+	return sigma * Generate([](Generator &generator) { return generator.normal(generator.gen); }) + mean;
+}
+
+
+
+Random::Stream::Stream(uint64_t seed)
+	: generator(new Generator), previous(stream)
+{
+	generator->gen.seed(seed);
+	stream = generator.get();
+}
+
+
+
+Random::Stream::~Stream()
+{
+	stream = previous;
 }
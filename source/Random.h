@@ -16,6 +16,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
 #include <cstdint>
+#include <memory>
 
 
 
@@ -23,6 +24,11 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 // different distributions. (This is done partly because on some systems the
 // random number generation is not thread-safe.)
 class Random {
+public:
+	class Generator;
+	class Stream;
+
+
 public:
 	// Seed the generator (e.g. to make it produce exactly the same random
 	// numbers it produced previously).
@@ -46,3 +52,23 @@ public:
 	// Get a number from a normal distribution with standard or specified mean and stddev.
 	static double Normal(double mean = 0, double sigma = 1);
 };
+
+
+
+// While a Stream exists, every random number requested by the thread that
+// created it is drawn from the stream's own generator instead of the shared one.
+// Work that is split across several threads can use this so that the numbers
+// it draws do not depend on which thread runs it, or in what order.
+class Random::Stream {
+public:
+	explicit Stream(uint64_t seed);
+	Stream(const Stream &) = delete;
+	Stream &operator=(const Stream &) = delete;
+	~Stream();
+
+
+private:
+	std::unique_ptr<Generator> generator;
+	// The stream that was active on this thread before this one, if any.
+	Generator *previous;
+};
@@ -47,6 +47,9 @@ public:
 	// Remove any objects in this set that are not in the given set, and for
 	// those that are in the given set, revert to their contents.
 	void Revert(const Set<Type> &other);
+	// Remove the object with the given name, if there is one. Any pointers to
+	// that object are no longer valid afterwards.
+	void Erase(const std::string &name) { data.erase(name); }
 
 
 private:
@@ -0,0 +1,234 @@
+/* ShipSpatialIndex.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ShipSpatialIndex.h"
+
+#include "Ship.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+using namespace std;
+
+namespace {
+	const vector<Ship *> EMPTY;
+
+	// Get the grid cell that the given coordinate falls in.
+	int Cell(double coordinate, double cellSize)
+	{
+		return floor(coordinate / cellSize);
+	}
+}
+
+
+
+// Initialize an index whose grid cells have the given size.
+ShipSpatialIndex::ShipSpatialIndex(unsigned cellSize)
+	: cellSize(max(1u, cellSize))
+{
+}
+
+
+
+// Remove all ships from the index.
+void ShipSpatialIndex::Clear()
+{
+	// Keep the buckets themselves around, so their storage can be reused.
+	for(auto &it : buckets)
+	{
+		it.second.ships.clear();
+		it.second.positions.clear();
+		it.second.sorted.clear();
+	}
+}
+
+
+
+// Add a ship to the index. Ships of the same government are always
+// returned in the order in which they were added.
+void ShipSpatialIndex::Add(Ship &ship)
+{
+	Bucket &bucket = buckets[ship.GetGovernment()];
+	bucket.ships.push_back(&ship);
+	bucket.positions.push_back(ship.Position());
+}
+
+
+
+// Finish adding ships, and sort them into the grid.
+void ShipSpatialIndex::Finish()
+{
+	for(auto &it : buckets)
+	{
+		Bucket &bucket = it.second;
+		if(bucket.ships.empty())
+			continue;
+
+		for(unsigned i = 0; i < bucket.positions.size(); ++i)
+			bucket.sorted.emplace_back(i, Cell(bucket.positions[i].X(), cellSize),
+				Cell(bucket.positions[i].Y(), cellSize));
+		sort(bucket.sorted.begin(), bucket.sorted.end());
+
+		bucket.minX = bucket.maxX = bucket.sorted.front().x;
+		bucket.minY = bucket.sorted.front().y;
+		bucket.maxY = bucket.sorted.back().y;
+		for(const Entry &entry : bucket.sorted)
+		{
+			bucket.minX = min(bucket.minX, entry.x);
+			bucket.maxX = max(bucket.maxX, entry.x);
+		}
+	}
+}
+
+
+
+// Get all the ships of the given government, in the order they were added.
+const vector<Ship *> &ShipSpatialIndex::All(const Government *government) const
+{
+	auto it = buckets.find(government);
+	return it == buckets.end() ? EMPTY : it->second.ships;
+}
+
+
+
+// Add to the result all ships of the given government that are closer than
+// the given range to the given point, in the order they were added.
+void ShipSpatialIndex::Circle(const Government *government, const Point &center, double range,
+	vector<Ship *> &result) const
+{
+	auto it = buckets.find(government);
+	if(it == buckets.end() || it->second.ships.empty())
+		return;
+	const Bucket &bucket = it->second;
+
+	vector<unsigned> found;
+	ForEachInSquare(bucket, center, range, [&](unsigned index)
+	{
+		if(center.Distance(bucket.positions[index]) < range)
+			found.push_back(index);
+	});
+
+	sort(found.begin(), found.end());
+	for(unsigned index : found)
+		result.push_back(bucket.ships[index]);
+}
+
+
+
+// Get up to the given number of ships of any of the given governments that
+// are closer than the given range to the given point, and that pass the
+// given filter. The result is sorted by distance, and ties are broken by the
+// order of the governments and then the order in which the ships were added.
+void ShipSpatialIndex::Nearest(const vector<const Government *> &governments, const Point &center, size_t count,
+	double range, const function<bool(const Ship &)> &filter, vector<Ship *> &result) const
+{
+	if(!count)
+		return;
+
+	// Each candidate is (distance, government, index).
+	vector<tuple<double, size_t, unsigned>> found;
+	vector<const Bucket *> searched;
+	for(const Government *government : governments)
+	{
+		auto it = buckets.find(government);
+		searched.push_back(it == buckets.end() || it->second.ships.empty() ? nullptr : &it->second);
+	}
+
+	// Search an ever larger square around the center until enough ships are
+	// found that are closer than the part of the square that was searched.
+	// Cells already searched are searched again, but the cost of that is
+	// bounded by the doubling of the search radius.
+	double radius = cellSize;
+	while(true)
+	{
+		double searchRange = min(radius, range);
+		found.clear();
+		bool coversAll = true;
+		for(size_t g = 0; g < searched.size(); ++g)
+		{
+			const Bucket *bucket = searched[g];
+			if(!bucket)
+				continue;
+			ForEachInSquare(*bucket, center, searchRange, [&](unsigned index)
+			{
+				double distance = center.Distance(bucket->positions[index]);
+				if(distance < searchRange && filter(*bucket->ships[index]))
+					found.emplace_back(distance, g, index);
+			});
+			// Check if every cell holding ships of this government lies entirely
+			// within the search range.
+			double dx = max(fabs(center.X() - bucket->minX * cellSize),
+				fabs(center.X() - (bucket->maxX + 1) * cellSize));
+			double dy = max(fabs(center.Y() - bucket->minY * cellSize),
+				fabs(center.Y() - (bucket->maxY + 1) * cellSize));
+			coversAll &= Point(dx, dy).Length() < searchRange;
+		}
+		if(found.size() >= count || coversAll || searchRange >= range)
+			break;
+		radius *= 2.;
+	}
+
+	sort(found.begin(), found.end());
+	if(found.size() > count)
+		found.resize(count);
+	for(const auto &[distance, g, index] : found)
+		result.push_back(searched[g]->ships[index]);
+}
+
+
+
+// Sort the entries row by row, and by the order they were added within a cell.
+bool ShipSpatialIndex::Entry::operator<(const Entry &other) const
+{
+	return tie(y, x, index) < tie(other.y, other.x, other.index);
+}
+
+
+
+// Call the given function for every ship of the bucket whose cell overlaps
+// the square around the given point.
+void ShipSpatialIndex::ForEachInSquare(const Bucket &bucket, const Point &center, double range,
+	const function<void(unsigned)> &function) const
+{
+	// Clamp the square to the cells that hold ships, before converting to cell
+	// coordinates, so that an infinite range is handled correctly.
+	double cellMinX = max<double>(bucket.minX, floor((center.X() - range) / cellSize));
+	double cellMaxX = min<double>(bucket.maxX, floor((center.X() + range) / cellSize));
+	double cellMinY = max<double>(bucket.minY, floor((center.Y() - range) / cellSize));
+	double cellMaxY = min<double>(bucket.maxY, floor((center.Y() + range) / cellSize));
+	if(cellMinX > cellMaxX || cellMinY > cellMaxY)
+		return;
+	int minX = cellMinX;
+	int maxX = cellMaxX;
+	int minY = cellMinY;
+	int maxY = cellMaxY;
+
+	// If the square covers every cell, there is no need to look anything up.
+	if(minX == bucket.minX && maxX == bucket.maxX && minY == bucket.minY && maxY == bucket.maxY)
+	{
+		for(unsigned i = 0; i < bucket.ships.size(); ++i)
+			function(i);
+		return;
+	}
+
+	// Each row of cells is stored contiguously, sorted by column.
+	for(int y = minY; y <= maxY; ++y)
+	{
+		auto it = lower_bound(bucket.sorted.begin(), bucket.sorted.end(), Entry(0, minX, y));
+		for( ; it != bucket.sorted.end() && it->y == y && it->x <= maxX; ++it)
+			function(it->index);
+	}
+}
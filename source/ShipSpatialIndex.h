@@ -0,0 +1,102 @@
+/* ShipSpatialIndex.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Point.h"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <vector>
+
+class Government;
+class Ship;
+
+
+
+// A ShipSpatialIndex sorts ships into a grid, separately for each government,
+// so that the ships of a government that are near a given point can be found
+// without looking at every ship of that government. The index records where
+// each ship was when it was added, so it must be rebuilt once the ships move.
+class ShipSpatialIndex {
+public:
+	// Initialize an index whose grid cells have the given size.
+	explicit ShipSpatialIndex(unsigned cellSize = 1024);
+
+	// Remove all ships from the index.
+	void Clear();
+	// Add a ship to the index. Ships of the same government are always
+	// returned in the order in which they were added.
+	void Add(Ship &ship);
+	// Finish adding ships, and sort them into the grid.
+	void Finish();
+
+	// Get all the ships of the given government, in the order they were added.
+	const std::vector<Ship *> &All(const Government *government) const;
+	// Add to the result all ships of the given government that are closer than
+	// the given range to the given point, in the order they were added.
+	void Circle(const Government *government, const Point &center, double range,
+		std::vector<Ship *> &result) const;
+	// Get up to the given number of ships of any of the given governments that
+	// are closer than the given range to the given point, and that pass the
+	// given filter. The result is sorted by distance, and ties are broken by the
+	// order of the governments and then the order in which the ships were added.
+	void Nearest(const std::vector<const Government *> &governments, const Point &center, size_t count,
+		double range, const std::function<bool(const Ship &)> &filter, std::vector<Ship *> &result) const;
+
+
+private:
+	class Entry {
+	public:
+		Entry() = default;
+		Entry(unsigned index, int x, int y) : index(index), x(x), y(y) {}
+
+		// Sort the entries row by row, and by the order they were added within a cell.
+		bool operator<(const Entry &other) const;
+
+		unsigned index;
+		int x;
+		int y;
+	};
+
+	class Bucket {
+	public:
+		// The ships of one government, in the order they were added.
+		std::vector<Ship *> ships;
+		std::vector<Point> positions;
+		// The ships sorted by the cell they are in.
+		std::vector<Entry> sorted;
+		// The range of cells that hold any ships.
+		int minX = 0;
+		int minY = 0;
+		int maxX = 0;
+		int maxY = 0;
+	};
+
+
+private:
+	// Call the given function for every ship of the bucket whose cell overlaps
+	// the square around the given point.
+	void ForEachInSquare(const Bucket &bucket, const Point &center, double range,
+		const std::function<void(unsigned)> &function) const;
+
+
+private:
+	// The size of individual cells of the grid.
+	double cellSize;
+
+	std::map<const Government *, Bucket> buckets;
+};
@@ -15,38 +15,127 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "TaskQueue.h"
 
+#include "Profiler.h"
+
 #include <algorithm>
-#include <chrono>
-#include <condition_variable>
+#include <array>
+#include <deque>
 #include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
 namespace {
-
-	// The main task queue used by the worker threads.
-	queue<TaskQueue::Task> tasks;
-	mutex asyncMutex;
-	condition_variable asyncCondition;
+	constexpr int PRIORITIES = 3;
+
+	// A task that waits to be run, and the queue it belongs to.
+	class Job {
+	public:
+		TaskQueue *queue = nullptr;
+		function<void()> task;
+	};
+
+	// A list of jobs for each priority.
+	class JobList {
+	public:
+		mutex jobMutex;
+		array<deque<Job>, PRIORITIES> jobs;
+	};
+
+	// The jobs queued by each worker thread. A worker takes the jobs it queued
+	// itself from the back, and other workers take them from the front.
+	vector<unique_ptr<JobList>> workerJobs;
+	// The jobs queued by threads that are not worker threads.
+	JobList sharedJobs;
+	// The index of the worker thread this is, or -1 for other threads.
+	thread_local int workerIndex = -1;
+
+	// Idle worker threads sleep until there are jobs to take.
+	mutex idleMutex;
+	condition_variable idleCondition;
+	size_t queuedJobs = 0;
 	bool shouldQuit = false;
 
+
+	// Take a job from the given list, from the front or the back. If a queue
+	// is given, only a job of that queue is taken.
+	bool TakeFrom(JobList &list, int priority, bool fromBack, const TaskQueue *only, Job &job)
+	{
+		lock_guard<mutex> lock(list.jobMutex);
+		deque<Job> &jobs = list.jobs[priority];
+		if(jobs.empty())
+			return false;
+
+		auto it = jobs.end();
+		if(!only)
+			it = fromBack ? prev(jobs.end()) : jobs.begin();
+		else if(fromBack)
+		{
+			auto rit = find_if(jobs.rbegin(), jobs.rend(), [only](const Job &job) { return job.queue == only; });
+			if(rit != jobs.rend())
+				it = prev(rit.base());
+		}
+		else
+			it = find_if(jobs.begin(), jobs.end(), [only](const Job &job) { return job.queue == only; });
+		if(it == jobs.end())
+			return false;
+
+		job = std::move(*it);
+		jobs.erase(it);
+		return true;
+	}
+
+	// Take the most urgent job that the current thread can find, looking at its
+	// own jobs first, then the shared jobs, and then the jobs of the other workers.
+	bool TakeJob(const TaskQueue *only, Job &job)
+	{
+		bool found = false;
+		for(int priority = 0; !found && priority < PRIORITIES; ++priority)
+		{
+			if(workerIndex >= 0 && TakeFrom(*workerJobs[workerIndex], priority, true, only, job))
+				found = true;
+			else if(TakeFrom(sharedJobs, priority, false, only, job))
+				found = true;
+			else
+				for(size_t i = 1; !found && i <= workerJobs.size(); ++i)
+					found = TakeFrom(*workerJobs[(workerIndex + i) % workerJobs.size()], priority, false, only, job);
+		}
+		if(found)
+		{
+			lock_guard<mutex> lock(idleMutex);
+			--queuedJobs;
+		}
+		return found;
+	}
+
 	// Worker threads for executing tasks.
 	struct WorkerThreads {
 		WorkerThreads(uint64_t threadCount = 0) noexcept
 		{
 			if(!threadCount)
 				threadCount = max(4u, thread::hardware_concurrency());
+			// Keep any jobs that the previous worker threads did not get to.
+			for(const unique_ptr<JobList> &list : workerJobs)
+				for(int priority = 0; priority < PRIORITIES; ++priority)
+					for(Job &job : list->jobs[priority])
+						sharedJobs.jobs[priority].push_back(std::move(job));
+			workerJobs.clear();
+			for(uint64_t i = 0; i < threadCount; ++i)
+				workerJobs.emplace_back(make_unique<JobList>());
+
 			threads.resize(threadCount);
-			for(thread &t : threads)
-				t = thread(&TaskQueue::ThreadLoop);
+			for(unsigned i = 0; i < threads.size(); ++i)
+				threads[i] = thread(&TaskQueue::ThreadLoop, i);
 		}
 		~WorkerThreads()
 		{
 			{
-				lock_guard<mutex> lock(asyncMutex);
+				lock_guard<mutex> lock(idleMutex);
 				shouldQuit = true;
 			}
-			asyncCondition.notify_all();
+			idleCondition.notify_all();
 			for(thread &t : threads)
 				t.join();
 		}
@@ -63,13 +152,28 @@ void TaskQueue::SetWorkerThreadCount(uint64_t count)
 		return;
 
 	threads.~WorkerThreads();
-	lock_guard<mutex> lock(asyncMutex);
+	lock_guard<mutex> lock(idleMutex);
 	shouldQuit = false;
 	new(&threads) WorkerThreads(count);
 }
 
 
 
+uint64_t TaskQueue::WorkerThreadCount()
+{
+	return threads.threads.size();
+}
+
+
+
+// Initialize a queue whose tasks have the given priority.
+TaskQueue::TaskQueue(Priority priority)
+	: priority(priority)
+{
+}
+
+
+
 TaskQueue::~TaskQueue()
 {
 	// Make sure every task that belongs to this queue is finished.
@@ -84,20 +188,35 @@ TaskQueue::~TaskQueue()
 // any main thread task that still need to be executed!
 shared_future<void> TaskQueue::Run(function<void()> asyncTask, function<void()> syncTask)
 {
-	shared_future<void> result;
+	auto promise = make_shared<std::promise<void>>();
+	shared_future<void> result = promise->get_future();
+	bool queuedTask = Submit([this, asyncTask = std::move(asyncTask), syncTask = std::move(syncTask), promise]() mutable
 	{
-		lock_guard<mutex> lock(asyncMutex);
-		// Do nothing if we are destroying the queue already.
-		if(shouldQuit)
-			return result;
+		try {
+			if(asyncTask)
+				asyncTask();
+		}
+		catch(...)
+		{
+			// Any exception by the task is caught and rethrown inside the main thread
+			// so we can handle it appropriately.
+			auto exception = current_exception();
+			syncTask = [exception] { rethrow_exception(exception); };
+		}
 
-		// Queue this task for execution and create a future to track its state.
-		tasks.push(Task{this, std::move(asyncTask), std::move(syncTask)});
-		result = futures.emplace_back(tasks.back().futurePromise.get_future());
-		tasks.back().futureIt = prev(futures.end());
-	}
-	asyncCondition.notify_one();
-	return result;
+		// If there is a followup function to execute, queue it for execution
+		// in the main thread.
+		if(syncTask)
+		{
+			lock_guard<mutex> lock(syncMutex);
+			syncTasks.push(std::move(syncTask));
+		}
+
+		// We are done and can mark the future as ready.
+		promise->set_value();
+	});
+	// Do nothing if we are destroying the queue already.
+	return queuedTask ? result : shared_future<void>();
 }
 
 
@@ -106,6 +225,10 @@ shared_future<void> TaskQueue::Run(function<void()> asyncTask, function<void()>
 void TaskQueue::ProcessSyncTasks()
 {
 	unique_lock<mutex> lock(syncMutex);
+	if(syncTasks.empty())
+		return;
+
+	Profiler::Scope scope("TaskQueue::ProcessSyncTasks");
 	for(int i = 0; !syncTasks.empty() && i < MAX_SYNC_TASKS; ++i)
 	{
 		// Extract the one item we should work on right now.
@@ -121,76 +244,135 @@ void TaskQueue::ProcessSyncTasks()
 
 
 // Waits for all of this queue's task to finish. Ignores any sync tasks to be processed.
+// While waiting, the calling thread runs any of this queue's tasks that have
+// not been started yet, and otherwise sleeps.
 void TaskQueue::Wait()
 {
-	while(!IsDone())
-		this_thread::yield();
+	while(true)
+	{
+		{
+			// Sleep until all tasks are done, or until there is a task that no
+			// other thread has started yet.
+			unique_lock<mutex> lock(stateMutex);
+			stateCondition.wait(lock, [this] { return !pending || queued; });
+			if(!pending)
+				return;
+		}
+
+		Job job;
+		if(TakeJob(this, job))
+			RunTask(job.task);
+	}
 }
 
 
 
-// Whether there are any outstanding async tasks left in this queue.
-bool TaskQueue::IsDone() const
+// Call the given function on consecutive ranges of [0, count), spreading them
+// over the worker threads. Each range holds at least grain items. The calling
+// thread handles the first range itself and then waits for the others to finish,
+// so this must only be used on a queue that has no other tasks in flight. If
+// the function throws, the exception is rethrown here once all ranges are done.
+void TaskQueue::ParallelFor(size_t count, size_t grain, const function<void(size_t, size_t)> &function)
 {
-	lock_guard<mutex> lock(asyncMutex);
-	return futures.empty();
+	if(!count)
+		return;
+
+	exception_ptr error;
+	mutex errorMutex;
+	auto RunRange = [&function, &error, &errorMutex](size_t begin, size_t end)
+	{
+		Profiler::Scope scope("TaskQueue::ParallelFor");
+		try {
+			function(begin, end);
+		}
+		catch(...)
+		{
+			lock_guard<mutex> lock(errorMutex);
+			if(!error)
+				error = current_exception();
+		}
+	};
+
+	const size_t rangeSize = max(max<size_t>(1, grain), count / (threads.threads.size() + 1) + 1);
+	for(size_t begin = rangeSize; begin < count; begin += rangeSize)
+		Submit([&RunRange, begin, end = min(count, begin + rangeSize)] { RunRange(begin, end); });
+	RunRange(0, min(count, rangeSize));
+	Wait();
+
+	if(error)
+		rethrow_exception(error);
 }
 
 
 
-// Thread entry point.
-void TaskQueue::ThreadLoop() noexcept
+// Thread entry point for the worker thread with the given index.
+void TaskQueue::ThreadLoop(unsigned index) noexcept
 {
+	workerIndex = index;
 	while(true)
 	{
-		unique_lock<mutex> lock(asyncMutex);
-		while(true)
+		Job job;
+		if(TakeJob(nullptr, job))
 		{
-			// Check whether it is time for this thread to quit.
-			if(shouldQuit)
-				return;
-			// No more tasks to execute, just go to sleep.
-			if(tasks.empty())
-				break;
+			job.queue->RunTask(job.task);
+			continue;
+		}
 
-			// Extract the one item we should work on reading right now.
-			auto task = std::move(tasks.front());
-			tasks.pop();
+		// No more tasks to execute, just go to sleep.
+		unique_lock<mutex> lock(idleMutex);
+		idleCondition.wait(lock, [] { return shouldQuit || queuedJobs; });
+		// Check whether it is time for this thread to quit.
+		if(shouldQuit)
+			return;
+	}
+}
 
-			// Unlock the mutex so other threads can access the queue.
-			lock.unlock();
 
-			// Execute the task.
-			try {
-				if(task.async)
-					task.async();
-			}
-			catch(...)
-			{
-				// Any exception by the task is caught and rethrown inside the main thread
-				// so we can handle it appropriately.
-				auto exception = current_exception();
-				task.sync = [exception] { rethrow_exception(exception); };
-			}
-
-			// If there is a followup function to execute, queue it for execution
-			// in the main thread.
-			if(task.sync)
-			{
-				unique_lock<mutex> lock(task.queue->syncMutex);
-				task.queue->syncTasks.push(std::move(task.sync));
-			}
 
-			// We are done and can mark the future as ready.
-			task.futurePromise.set_value();
+// Queue a task to be run by the worker threads. Returns false if the
+// worker threads are shutting down.
+bool TaskQueue::Submit(function<void()> task)
+{
+	{
+		lock_guard<mutex> lock(idleMutex);
+		if(shouldQuit)
+			return false;
+	}
+	{
+		lock_guard<mutex> lock(stateMutex);
+		++pending;
+		++queued;
+	}
+	// A worker thread keeps the tasks it queues for itself, unless another
+	// worker takes them first.
+	JobList &list = workerIndex >= 0 ? *workerJobs[workerIndex] : sharedJobs;
+	{
+		lock_guard<mutex> lock(list.jobMutex);
+		list.jobs[static_cast<int>(priority)].push_back(Job{this, std::move(task)});
+	}
+	{
+		lock_guard<mutex> lock(idleMutex);
+		++queuedJobs;
+	}
+	idleCondition.notify_one();
+	// Wake up anyone waiting for this queue, so they can help to run the task.
+	stateCondition.notify_all();
+	return true;
+}
 
-			lock.lock();
 
-			// Now that the task has been executed, stop tracking the future internally.
-			// Anybody who still cares about the future will have a copy themselves.
-			task.queue->futures.erase(task.futureIt);
-		}
 
-		asyncCondition.wait(lock, [] { return shouldQuit || !tasks.empty(); });
+// Run a task of this queue that was taken from the worker threads' lists.
+void TaskQueue::RunTask(function<void()> &task)
+{
+	{
+		lock_guard<mutex> lock(stateMutex);
+		--queued;
 	}
+	task();
+	// The queue may be destroyed as soon as a waiting thread sees that no tasks
+	// are pending, so notify it while still holding the lock.
+	lock_guard<mutex> lock(stateMutex);
+	if(!--pending)
+		stateCondition.notify_all();
 }
@@ -15,9 +15,11 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <future>
-#include <list>
 #include <mutex>
 #include <queue>
 
@@ -28,22 +30,19 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 // The queue is also responsible to execute follow-up tasks that need to
 // executed after the async task, for example uploading a loaded to the GPU
 // (which needs to happen on the main thread on OpenGL).
+// The tasks of all queues are run by one shared set of worker threads. Each
+// worker keeps its own list of tasks, and workers that run out of tasks take
+// them from the others. The tasks of more urgent queues are always started first.
 class TaskQueue {
 public:
-	// An internal structure representing a task to execute.
-	struct Task {
-		TaskQueue *queue;
-
-		// The function to execute in parallel.
-		std::function<void()> async;
-		// If specified, this function is called in the main thread after
-		// the function above has finished executing.
-		std::function<void()> sync;
-
-		// The pointer to this task's future stored in the queue.
-		std::list<std::shared_future<void>>::const_iterator futureIt;
-
-		std::promise<void> futurePromise;
+	// How urgently the tasks of a queue need to be run. A worker always starts
+	// the most urgent task that it can find.
+	enum class Priority : int {
+		// Tasks that the simulation of the current frame is waiting for.
+		HIGH,
+		NORMAL,
+		// Tasks that nothing is waiting for right away, like loading deferred sprites.
+		LOW
 	};
 
 	// The maximum amount of sync tasks to execute in one go.
@@ -54,11 +53,13 @@ public:
 	// Set the number of worker threads for TaskQueues to run their tasks on.
 	// If not used, a default based on system resources will be chosen.
 	static void SetWorkerThreadCount(uint64_t count);
+	// Get the number of worker threads that TaskQueues run their tasks on.
+	static uint64_t WorkerThreadCount();
 
 
 public:
-	// Initialize the threads used to execute the tasks.
-	TaskQueue() = default;
+	// Initialize a queue whose tasks have the given priority.
+	explicit TaskQueue(Priority priority = Priority::NORMAL);
 	TaskQueue(const TaskQueue &) = delete;
 	TaskQueue &operator=(const TaskQueue &) = delete;
 	~TaskQueue();
@@ -73,21 +74,40 @@ public:
 	void ProcessSyncTasks();
 
 	// Waits for all of this queue's task to finish. Ignores any sync tasks to be processed.
+	// While waiting, the calling thread runs any of this queue's tasks that have
+	// not been started yet, and otherwise sleeps.
 	void Wait();
 
-
-private:
-	// Whether there are any outstanding async tasks left in this queue.
-	bool IsDone() const;
+	// Call the given function on consecutive ranges of [0, count), spreading them
+	// over the worker threads. Each range holds at least grain items. The calling
+	// thread handles the first range itself and then waits for the others to finish,
+	// so this must only be used on a queue that has no other tasks in flight. If
+	// the function throws, the exception is rethrown here once all ranges are done.
+	void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &function);
 
 
 public:
-	// Thread entry point.
-	static void ThreadLoop() noexcept;
+	// Thread entry point for the worker thread with the given index.
+	static void ThreadLoop(unsigned index) noexcept;
+
+
+private:
+	// Queue a task to be run by the worker threads. Returns false if the
+	// worker threads are shutting down.
+	bool Submit(std::function<void()> task);
+	// Run a task of this queue that was taken from the worker threads' lists.
+	void RunTask(std::function<void()> &task);
 
 
 private:
-	std::list<std::shared_future<void>> futures;
+	Priority priority;
+
+	// The number of this queue's tasks that have not finished, and of those the
+	// number that have not been started yet.
+	size_t pending = 0;
+	size_t queued = 0;
+	std::mutex stateMutex;
+	std::condition_variable stateCondition;
 
 	// Tasks from this queue that need to be executed on the main thread.
 	std::queue<std::function<void()>> syncTasks;
@@ -120,5 +120,5 @@ private:
 	// The sync queue will wait at the end of the step for all
 	// tasks to be completed, while the async queue does not.
 	TaskQueue syncQueue;
-	TaskQueue asyncQueue;
+	TaskQueue asyncQueue{TaskQueue::Priority::LOW};
 };
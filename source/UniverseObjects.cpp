@@ -15,7 +15,9 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "UniverseObjects.h"
 
+#include "DataCache.h"
 #include "DataFile.h"
+#include "DataFileQueue.h"
 #include "DataNode.h"
 #include "Files.h"
 #include "Information.h"
@@ -35,6 +37,11 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 using namespace std;
 
+namespace {
+	// How many files may be parsed ahead of the file that is being loaded.
+	const size_t PARSE_AHEAD = 32;
+}
+
 
 
 shared_future<void> UniverseObjects::Load(TaskQueue &queue, const vector<filesystem::path> &sources,
@@ -60,16 +67,32 @@ shared_future<void> UniverseObjects::Load(TaskQueue &queue, const vector<filesys
 						make_move_iterator(list.end()));
 			}
 
-			const double step = 1. / (static_cast<int>(files.size()) + 1);
-			for(const auto &path : files)
+			// Only text files hold data. Any other files, like images, are skipped.
+			erase_if(files, [](const filesystem::path &path) { return path.extension() != ".txt"; });
+
+			// Parsing each file does not depend on any other file, so files are
+			// parsed in parallel, a few files ahead of the one being loaded. But
+			// the nodes must be loaded in order, so that later files can override
+			// earlier ones. Files that have not changed since the last time they
+			// were parsed are loaded from the cache instead. The cache must outlive
+			// the queue, whose tasks use it until the queue is destroyed.
+			DataCache cache(Files::Config() / "data cache");
 			{
-				LoadFile(path, player, globalConditions, debugMode);
+				DataFileQueue parsed(std::move(files),
+					[&cache](const filesystem::path &path, DataFile &file) { cache.Load(path, file); }, PARSE_AHEAD);
+
+				const double step = 1. / (static_cast<int>(parsed.Size()) + 1);
+				for(size_t i = 0; i < parsed.Size(); ++i)
+				{
+					LoadFile(parsed.Path(i), parsed.Take(i), player, globalConditions, debugMode);
 
-				// Increment the atomic progress by one step.
-				// We use acquire + release to prevent any reordering.
-				auto val = progress.load(memory_order_acquire);
-				progress.store(val + step, memory_order_release);
+					// Increment the atomic progress by one step.
+					// We use acquire + release to prevent any reordering.
+					auto val = progress.load(memory_order_acquire);
+					progress.store(val + step, memory_order_release);
+				}
 			}
+			cache.RemoveUnused();
 			FinishLoading();
 			progress = 1.;
 		});
@@ -135,6 +158,8 @@ void UniverseObjects::FinishLoading()
 	// Sort all category lists.
 	for(auto &list : categories)
 		list.second.Sort();
+
+	missionOffers.Build(missions);
 }
 
 
@@ -360,14 +385,9 @@ void UniverseObjects::DrawMenuBackground(Panel *panel) const
 
 
 
-void UniverseObjects::LoadFile(const filesystem::path &path, const PlayerInfo &player,
+void UniverseObjects::LoadFile(const filesystem::path &path, const DataFile &data, const PlayerInfo &player,
 		const ConditionsStore *globalConditions, bool debugMode)
 {
-	// This is an ordinary file. Check to see if it is an image.
-	if(path.extension() != ".txt")
-		return;
-
-	DataFile data(path);
 	if(debugMode)
 		Logger::Log("Parsing: " + path.string(), Logger::Level::INFO);
 
@@ -34,6 +34,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Message.h"
 #include "Minable.h"
 #include "Mission.h"
+#include "MissionOfferIndex.h"
 #include "News.h"
 #include "Outfit.h"
 #include "Person.h"
@@ -61,6 +62,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <vector>
 
 class ConditionsStore;
+class DataFile;
 class Panel;
 class PlayerInfo;
 class Sprite;
@@ -100,7 +102,8 @@ public:
 
 
 private:
-	void LoadFile(const std::filesystem::path &path, const PlayerInfo &player,
+	// Load the nodes of the given file, which was parsed from the given path.
+	void LoadFile(const std::filesystem::path &path, const DataFile &data, const PlayerInfo &player,
 		const ConditionsStore *globalConditions, bool debugMode = false);
 
 
@@ -140,6 +143,8 @@ private:
 	Set<Wormhole> wormholes;
 	Set<Gamerules> gamerulesPresets;
 
+	// This is used for speeding up the search for missions to offer.
+	MissionOfferIndex missionOffers;
 	// This is used for speeding up the route calculations.
 	std::set<std::string> universeWormholeRequirements;
 	std::set<double> neighborDistances;
@@ -23,6 +23,16 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <jpeglib.h>
 #include <png.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+// The AVX2 kernels are compiled separately for that instruction set, and are
+// only used if the processor running the game supports it.
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define IMAGE_BUFFER_AVX2
+#include <immintrin.h>
+#endif
+
 #include <cmath>
 #include <memory>
 #include <set>
@@ -48,7 +58,56 @@ namespace {
 	bool ReadJPG(const filesystem::path &path, ImageBuffer &buffer, int frame, bool onlyDimensions);
 	int ReadAVIF(const filesystem::path &path, ImageBuffer &buffer, int frame, bool alphaPreMultiplied,
 		bool onlyDimensions);
-	void Premultiply(ImageBuffer &buffer, int frame, BlendingMode additive);
+	// Kernels that convert a run of pixels to premultiplied alpha (or additive
+	// or half-additive blending), and that average two rows of pixels down to one
+	// row of half the width.
+	void PremultiplyScalar(uint32_t *it, uint32_t *end, BlendingMode blend);
+	void ShrinkRowScalar(const uint32_t *a, const uint32_t *b, uint32_t *out, int outWidth);
+#ifdef __SSE2__
+	void PremultiplySSE2(uint32_t *it, uint32_t *end, BlendingMode blend);
+	void ShrinkRowSSE2(const uint32_t *a, const uint32_t *b, uint32_t *out, int outWidth);
+#endif
+#ifdef IMAGE_BUFFER_AVX2
+	void PremultiplyAVX2(uint32_t *it, uint32_t *end, BlendingMode blend);
+	void ShrinkRowAVX2(const uint32_t *a, const uint32_t *b, uint32_t *out, int outWidth);
+#endif
+
+	// Pick the fastest kernels that the processor supports.
+	using PremultiplyKernel = void (*)(uint32_t *, uint32_t *, BlendingMode);
+	using ShrinkRowKernel = void (*)(const uint32_t *, const uint32_t *, uint32_t *, int);
+	bool HasAVX2()
+	{
+#ifdef IMAGE_BUFFER_AVX2
+		static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+		return hasAVX2;
+#else
+		return false;
+#endif
+	}
+	PremultiplyKernel GetPremultiplyKernel()
+	{
+#ifdef IMAGE_BUFFER_AVX2
+		if(HasAVX2())
+			return PremultiplyAVX2;
+#endif
+#ifdef __SSE2__
+		return PremultiplySSE2;
+#else
+		return PremultiplyScalar;
+#endif
+	}
+	ShrinkRowKernel GetShrinkRowKernel()
+	{
+#ifdef IMAGE_BUFFER_AVX2
+		if(HasAVX2())
+			return ShrinkRowAVX2;
+#endif
+#ifdef __SSE2__
+		return ShrinkRowSSE2;
+#else
+		return ShrinkRowScalar;
+#endif
+	}
 }
 
 
@@ -164,21 +223,12 @@ bool ImageBuffer::ShrinkToHalfSize()
 	ImageBuffer result(frames);
 	result.Allocate(width / 2, height / 2);
 
-	unsigned char *begin = reinterpret_cast<unsigned char *>(pixels);
-	unsigned char *out = reinterpret_cast<unsigned char *>(result.pixels);
+	static const ShrinkRowKernel ShrinkRow = GetShrinkRowKernel();
 	// Loop through every line of every frame of the buffer.
 	for(int y = 0; y < result.height * frames; ++y)
-	{
-		unsigned char *aIt = begin + (4 * width) * (2 * y);
-		unsigned char *aEnd = aIt + 4 * 2 * result.width;
-		unsigned char *bIt = begin + (4 * width) * (2 * y + 1);
-		for( ; aIt != aEnd; aIt += 4, bIt += 4)
-		{
-			for(int channel = 0; channel < 4; ++channel, ++aIt, ++bIt, ++out)
-				*out = (static_cast<unsigned>(aIt[0]) + static_cast<unsigned>(bIt[0])
-					+ static_cast<unsigned>(aIt[4]) + static_cast<unsigned>(bIt[4]) + 2) / 4;
-		}
-	}
+		ShrinkRow(pixels + width * (2 * y), pixels + width * (2 * y + 1),
+			result.pixels + result.width * y, result.width);
+
 	swap(width, result.width);
 	swap(height, result.height);
 	swap(pixels, result.pixels);
@@ -187,6 +237,19 @@ bool ImageBuffer::ShrinkToHalfSize()
 
 
 
+// Convert the given frame to premultiplied alpha, or to additive or half-additive
+// blending. Each color channel is multiplied by the alpha and divided by 255,
+// rounding down. Additive pixels get an alpha of 0, and half-additive ones get
+// a quarter of their original alpha.
+void ImageBuffer::Premultiply(int frame, BlendingMode blend)
+{
+	static const PremultiplyKernel Kernel = GetPremultiplyKernel();
+	uint32_t *begin = Begin(0, frame);
+	Kernel(begin, begin + width * height, blend);
+}
+
+
+
 int ImageBuffer::Read(const ImageFileData &data, int frame, bool onlyDimensions)
 {
 	// First, make sure this is a supported file.
@@ -214,7 +277,7 @@ int ImageBuffer::Read(const ImageFileData &data, int frame, bool onlyDimensions)
 	if(!isAlphaPreMultiplied)
 	{
 		if(isPNG || (isJPG && data.blendingMode == BlendingMode::ADDITIVE))
-			Premultiply(*this, frame, data.blendingMode);
+			Premultiply(frame, data.blendingMode);
 	}
 	return loaded;
 }
@@ -537,29 +600,174 @@ namespace {
 
 
 
-	void Premultiply(ImageBuffer &buffer, int frame, BlendingMode blend)
+	void PremultiplyScalar(uint32_t *it, uint32_t *end, BlendingMode blend)
 	{
-		for(int y = 0; y < buffer.Height(); ++y)
+		for( ; it != end; ++it)
 		{
-			uint32_t *it = buffer.Begin(y, frame);
+			uint64_t value = *it;
+			uint64_t alpha = (value & 0xFF000000) >> 24;
 
-			for(uint32_t *end = it + buffer.Width(); it != end; ++it)
-			{
-				uint64_t value = *it;
-				uint64_t alpha = (value & 0xFF000000) >> 24;
+			uint64_t red = (((value & 0xFF0000) * alpha) / 255) & 0xFF0000;
+			uint64_t green = (((value & 0xFF00) * alpha) / 255) & 0xFF00;
+			uint64_t blue = (((value & 0xFF) * alpha) / 255) & 0xFF;
 
-				uint64_t red = (((value & 0xFF0000) * alpha) / 255) & 0xFF0000;
-				uint64_t green = (((value & 0xFF00) * alpha) / 255) & 0xFF00;
-				uint64_t blue = (((value & 0xFF) * alpha) / 255) & 0xFF;
+			value = red | green | blue;
+			if(blend == BlendingMode::HALF_ADDITIVE)
+				alpha >>= 2;
+			if(blend != BlendingMode::ADDITIVE)
+				value |= (alpha << 24);
 
-				value = red | green | blue;
-				if(blend == BlendingMode::HALF_ADDITIVE)
-					alpha >>= 2;
-				if(blend != BlendingMode::ADDITIVE)
-					value |= (alpha << 24);
+			*it = static_cast<uint32_t>(value);
+		}
+	}
 
-				*it = static_cast<uint32_t>(value);
-			}
+
+
+	void ShrinkRowScalar(const uint32_t *a, const uint32_t *b, uint32_t *out, int outWidth)
+	{
+		const unsigned char *aIt = reinterpret_cast<const unsigned char *>(a);
+		const unsigned char *aEnd = aIt + 4 * 2 * outWidth;
+		const unsigned char *bIt = reinterpret_cast<const unsigned char *>(b);
+		unsigned char *outIt = reinterpret_cast<unsigned char *>(out);
+		for( ; aIt != aEnd; aIt += 4, bIt += 4)
+		{
+			for(int channel = 0; channel < 4; ++channel, ++aIt, ++bIt, ++outIt)
+				*outIt = (static_cast<unsigned>(aIt[0]) + static_cast<unsigned>(bIt[0])
+					+ static_cast<unsigned>(aIt[4]) + static_cast<unsigned>(bIt[4]) + 2) / 4;
 		}
 	}
+
+
+
+#ifdef __SSE2__
+	// Multiply the color channels of the two pixels in each half of the given 16-bit
+	// channels by their alphas, and replace the alphas as the blending mode requires.
+	// Dividing by 255 and rounding down is done as (x + 1 + (x >> 8)) >> 8, which
+	// is exact for every product of two bytes.
+	__m128i PremultiplyChannels(__m128i channels, __m128i alphaMask, __m128i alphaShift)
+	{
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, 0xFF), 0xFF);
+		__m128i product = _mm_mullo_epi16(channels, alpha);
+		product = _mm_add_epi16(product, _mm_add_epi16(_mm_srli_epi16(product, 8), _mm_set1_epi16(1)));
+		product = _mm_srli_epi16(product, 8);
+		__m128i newAlpha = _mm_and_si128(_mm_srl_epi16(alpha, alphaShift), alphaMask);
+		return _mm_or_si128(_mm_andnot_si128(_mm_set1_epi64x(0xFFFF000000000000), product), newAlpha);
+	}
+
+
+
+	void PremultiplySSE2(uint32_t *it, uint32_t *end, BlendingMode blend)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alphaMask = blend == BlendingMode::ADDITIVE ? zero : _mm_set1_epi64x(0xFFFF000000000000);
+		const __m128i alphaShift = _mm_cvtsi32_si128(blend == BlendingMode::HALF_ADDITIVE ? 2 : 0);
+		for( ; end - it >= 4; it += 4)
+		{
+			__m128i *block = reinterpret_cast<__m128i *>(it);
+			__m128i pixels = _mm_loadu_si128(block);
+			__m128i low = PremultiplyChannels(_mm_unpacklo_epi8(pixels, zero), alphaMask, alphaShift);
+			__m128i high = PremultiplyChannels(_mm_unpackhi_epi8(pixels, zero), alphaMask, alphaShift);
+			_mm_storeu_si128(block, _mm_packus_epi16(low, high));
+		}
+		PremultiplyScalar(it, end, blend);
+	}
+
+
+
+	// Average four pixels from each of the two given rows into two output pixels.
+	__m128i ShrinkBlock(__m128i a, __m128i b)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		// Add the rows together, as two pairs of pixels.
+		__m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+		__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+		// Then add the pixels of each pair together.
+		__m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+		return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+	}
+
+
+
+	void ShrinkRowSSE2(const uint32_t *a, const uint32_t *b, uint32_t *out, int outWidth)
+	{
+		int x = 0;
+		for( ; x + 4 <= outWidth; x += 4)
+		{
+			const __m128i *aBlock = reinterpret_cast<const __m128i *>(a + 2 * x);
+			const __m128i *bBlock = reinterpret_cast<const __m128i *>(b + 2 * x);
+			__m128i first = ShrinkBlock(_mm_loadu_si128(aBlock), _mm_loadu_si128(bBlock));
+			__m128i second = ShrinkBlock(_mm_loadu_si128(aBlock + 1), _mm_loadu_si128(bBlock + 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), _mm_packus_epi16(first, second));
+		}
+		ShrinkRowScalar(a + 2 * x, b + 2 * x, out + x, outWidth - x);
+	}
+#endif
+
+
+
+#ifdef IMAGE_BUFFER_AVX2
+	// The AVX2 kernels work like the SSE2 ones, except on twice as many pixels.
+	// Unpacking and packing both work within each 128-bit half, so the pixels
+	// only need to be reordered after shrinking.
+	__attribute__((target("avx2")))
+	__m256i PremultiplyChannels(__m256i channels, __m256i alphaMask, __m128i alphaShift)
+	{
+		__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(channels, 0xFF), 0xFF);
+		__m256i product = _mm256_mullo_epi16(channels, alpha);
+		product = _mm256_add_epi16(product, _mm256_add_epi16(_mm256_srli_epi16(product, 8), _mm256_set1_epi16(1)));
+		product = _mm256_srli_epi16(product, 8);
+		__m256i newAlpha = _mm256_and_si256(_mm256_srl_epi16(alpha, alphaShift), alphaMask);
+		return _mm256_or_si256(_mm256_andnot_si256(_mm256_set1_epi64x(0xFFFF000000000000), product), newAlpha);
+	}
+
+
+
+	__attribute__((target("avx2")))
+	void PremultiplyAVX2(uint32_t *it, uint32_t *end, BlendingMode blend)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i alphaMask = blend == BlendingMode::ADDITIVE ? zero : _mm256_set1_epi64x(0xFFFF000000000000);
+		const __m128i alphaShift = _mm_cvtsi32_si128(blend == BlendingMode::HALF_ADDITIVE ? 2 : 0);
+		for( ; end - it >= 8; it += 8)
+		{
+			__m256i *block = reinterpret_cast<__m256i *>(it);
+			__m256i pixels = _mm256_loadu_si256(block);
+			__m256i low = PremultiplyChannels(_mm256_unpacklo_epi8(pixels, zero), alphaMask, alphaShift);
+			__m256i high = PremultiplyChannels(_mm256_unpackhi_epi8(pixels, zero), alphaMask, alphaShift);
+			_mm256_storeu_si256(block, _mm256_packus_epi16(low, high));
+		}
+		PremultiplySSE2(it, end, blend);
+	}
+
+
+
+	__attribute__((target("avx2")))
+	__m256i ShrinkBlock(__m256i a, __m256i b)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i low = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+		__m256i high = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+		__m256i sum = _mm256_add_epi16(_mm256_unpacklo_epi64(low, high), _mm256_unpackhi_epi64(low, high));
+		return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(2)), 2);
+	}
+
+
+
+	__attribute__((target("avx2")))
+	void ShrinkRowAVX2(const uint32_t *a, const uint32_t *b, uint32_t *out, int outWidth)
+	{
+		int x = 0;
+		for( ; x + 8 <= outWidth; x += 8)
+		{
+			const __m256i *aBlock = reinterpret_cast<const __m256i *>(a + 2 * x);
+			const __m256i *bBlock = reinterpret_cast<const __m256i *>(b + 2 * x);
+			__m256i first = ShrinkBlock(_mm256_loadu_si256(aBlock), _mm256_loadu_si256(bBlock));
+			__m256i second = ShrinkBlock(_mm256_loadu_si256(aBlock + 1), _mm256_loadu_si256(bBlock + 1));
+			// Packing leaves the pairs of output pixels in the order 0, 2, 1, 3.
+			__m256i packed = _mm256_packus_epi16(first, second);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + x), _mm256_permute4x64_epi64(packed, 0xD8));
+		}
+		ShrinkRowSSE2(a + 2 * x, b + 2 * x, out + x, outWidth - x);
+	}
+#endif
 }
@@ -15,6 +15,8 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include "BlendingMode.h"
+
 #include <cstdint>
 #include <set>
 #include <string>
@@ -66,6 +68,10 @@ public:
 	// Return false if either dimension is too small (< 2).
 	bool ShrinkToHalfSize();
 
+	// Convert the given frame to premultiplied alpha, or to additive or
+	// half-additive blending.
+	void Premultiply(int frame, BlendingMode blend);
+
 	// Read frames from a file. Return the number of frames read,
 	// or 0 if an error is encountered - either the
 	// image is the wrong size, or it is not a supported image format.
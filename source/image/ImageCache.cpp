@@ -0,0 +1,114 @@
+/* ImageCache.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ImageCache.h"
+
+#include "../BinaryData.h"
+#include "ImageBuffer.h"
+#include "../MappedFile.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+using namespace std;
+
+namespace {
+	// The cached frames start with this, followed by a version number that
+	// must be changed whenever the way frames are stored or decoded changes.
+	const uint32_t BINARY_MAGIC = 0x47494D45;
+	const uint32_t BINARY_VERSION = 1;
+
+	// The suffixes that are added to the sprite name for each variant.
+	const string VARIANT_SUFFIX[] = {"", "@2x", "@sw", "@2x@sw"};
+}
+
+
+
+// Keep the cached frames in the given directory. If it cannot be created,
+// frames are always decoded.
+ImageCache::ImageCache(const filesystem::path &directory)
+	: folder(directory)
+{
+}
+
+
+
+// Load the cached frames of the given variant of a sprite into the buffer,
+// if they match the given key. The variants are numbered in the same way
+// as the buffers of an ImageSet: 1x, @2x, 1x swizzle mask, @2x swizzle mask.
+// The key should be the CacheFolder::FileKey() of the variant's frames; if
+// it is empty, the frames are never cached.
+bool ImageCache::Load(const string &name, int variant, const string &key, ImageBuffer &buffer)
+{
+	if(key.empty() || !folder.IsEnabled())
+		return false;
+
+	MappedFile cached(folder.Use(name + VARIANT_SUFFIX[variant]));
+	BinaryReader in(cached.View());
+	if(in.Read<uint32_t>() != BINARY_MAGIC || in.Read<uint32_t>() != BINARY_VERSION || in.ReadText() != key)
+		return false;
+
+	uint32_t width = in.Read<uint32_t>();
+	uint32_t height = in.Read<uint32_t>();
+	uint32_t frames = in.Read<uint32_t>();
+	string_view pixels = in.ReadText();
+	if(!in.IsValid() || !in.AtEnd() || !width || !height || !frames
+			|| pixels.size() / sizeof(uint32_t) / width / height != frames
+			|| pixels.size() != sizeof(uint32_t) * width * height * frames)
+		return false;
+
+	buffer.Clear(frames);
+	buffer.Allocate(width, height);
+	memcpy(buffer.Pixels(), pixels.data(), pixels.size());
+	return true;
+}
+
+
+
+// Cache the frames of the given variant of a sprite.
+void ImageCache::Save(const string &name, int variant, const string &key, const ImageBuffer &buffer)
+{
+	if(key.empty() || !folder.IsEnabled() || !buffer.Pixels())
+		return;
+
+	BinaryWriter out;
+	out.Write(BINARY_MAGIC);
+	out.Write(BINARY_VERSION);
+	out.WriteText(key);
+	out.Write<uint32_t>(buffer.Width());
+	out.Write<uint32_t>(buffer.Height());
+	out.Write<uint32_t>(buffer.Frames());
+	out.WriteText(string_view(reinterpret_cast<const char *>(buffer.Pixels()),
+		sizeof(uint32_t) * buffer.Width() * buffer.Height() * buffer.Frames()));
+	folder.Write(folder.Use(name + VARIANT_SUFFIX[variant]), out.Data());
+}
+
+
+
+// Keep the cached frames of the given sprite, even if they are not used.
+void ImageCache::Keep(const string &name)
+{
+	for(const string &suffix : VARIANT_SUFFIX)
+		folder.Use(name + suffix);
+}
+
+
+
+// Delete any cached frames that were not used or kept since this cache was created.
+void ImageCache::RemoveUnused() const
+{
+	folder.RemoveUnused();
+}
@@ -0,0 +1,57 @@
+/* ImageCache.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "../CacheFolder.h"
+
+#include <filesystem>
+#include <string>
+
+class ImageBuffer;
+
+
+
+// An ImageCache keeps the decoded and premultiplied frames of sprites on disk,
+// so that they can be copied straight into an ImageBuffer instead of being
+// decoded again each time the game starts. Each resolution and swizzle mask
+// variant of a sprite is cached separately, along with the path, size,
+// modification time and hash of the contents of each of its frames; the
+// blending mode is part of each path. If any of those differ, the frames are
+// decoded again. The frames are stored uncompressed, so this trades disk space
+// for startup time. Frames can be loaded and saved from several threads at once.
+class ImageCache {
+public:
+	// Keep the cached frames in the given directory. If it cannot be created,
+	// frames are always decoded.
+	explicit ImageCache(const std::filesystem::path &directory);
+
+	// Load the cached frames of the given variant of a sprite into the buffer,
+	// if they match the given key. The variants are numbered in the same way
+	// as the buffers of an ImageSet: 1x, @2x, 1x swizzle mask, @2x swizzle mask.
+	// The key should be the CacheFolder::FileKey() of the variant's frames; if
+	// it is empty, the frames are never cached.
+	bool Load(const std::string &name, int variant, const std::string &key, ImageBuffer &buffer);
+	// Cache the frames of the given variant of a sprite.
+	void Save(const std::string &name, int variant, const std::string &key, const ImageBuffer &buffer);
+	// Keep the cached frames of the given sprite, even if they are not used.
+	void Keep(const std::string &name);
+	// Delete any cached frames that were not used or kept since this cache was created.
+	void RemoveUnused() const;
+
+
+private:
+	CacheFolder folder;
+};
@@ -15,17 +15,23 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "ImageSet.h"
 
+#include "../CacheFolder.h"
 #include "../text/Format.h"
 #include "../GameData.h"
 #include "ImageBuffer.h"
+#include "ImageCache.h"
 #include "ImageFileData.h"
 #include "../Logger.h"
 #include "Mask.h"
+#include "MaskCache.h"
 #include "MaskManager.h"
 #include "Sprite.h"
+#include "../TaskQueue.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <functional>
 
 using namespace std;
 
@@ -76,6 +82,26 @@ namespace {
 				+ (ignored > 1 ? " frames" : " frame") + " ignored in total).", Logger::Level::WARNING);
 		}
 	}
+
+	// Call the given function to read each of the given number of frames into the buffer.
+	// The buffer is allocated by the first frame that is read successfully, so frames are
+	// read one at a time until that has happened. The remaining frames each go into their
+	// own part of the buffer, so they are decoded in parallel.
+	void ReadFrames(ImageBuffer &buffer, size_t count, const function<void(size_t)> &read)
+	{
+		size_t first = 0;
+		while(first < count && !buffer.Pixels())
+			read(first++);
+		if(first >= count)
+			return;
+
+		TaskQueue queue;
+		queue.ParallelFor(count - first, 1, [&read, first](size_t begin, size_t end)
+		{
+			for(size_t i = begin; i < end; ++i)
+				read(first + i);
+		});
+	}
 }
 
 
@@ -175,8 +201,9 @@ void ImageSet::ValidateFrames() noexcept(false)
 
 
 // Load all the frames. This should be called in one of the image-loading
-// worker threads. This also generates collision masks if needed.
-void ImageSet::Load() noexcept(false)
+// worker threads. This also generates collision masks if needed. If any
+// caches are given, the frames and masks are taken from them if possible.
+void ImageSet::Load(MaskCache *maskCache, ImageCache *imageCache) noexcept(false)
 {
 	assert(framePaths[0].empty() && "should call ValidateFrames before calling Load");
 
@@ -210,48 +237,97 @@ void ImageSet::Load() noexcept(false)
 	buffer[0].Clear(frames);
 	UpdateFrameCount();
 
+	// Cached frames and masks are only used if none of the files they came from changed.
+	string fileKeys[4];
+	if(imageCache || (maskCache && makeMasks))
+		fileKeys[0] = CacheFolder::FileKey(paths[0]);
+	if(imageCache)
+		for(int i = 1; i < 4; ++i)
+			fileKeys[i] = CacheFolder::FileKey(paths[i]);
+
 	// Load the 1x sprites first, then the 2x sprites, because they are likely
-	// to be in separate locations on the disk. Create masks if needed.
-	for(size_t i = 0; i < paths[0].size(); ++i)
+	// to be in separate locations on the disk.
+	vector<char> loaded(paths[0].size(), false);
+	if(imageCache && imageCache->Load(name, 0, fileKeys[0], buffer[0]))
 	{
-		int loadedFrames = buffer[0].Read(paths[0][i], i);
-		const string fileName = "\"" + name + "\" frame #" + to_string(i);
-		if(!loadedFrames)
-		{
-			Logger::Log("Failed to read image data for " + fileName, Logger::Level::WARNING);
-			continue;
-		}
-		// If we loaded an image sequence, clear all other buffers.
-		if(loadedFrames > 1)
-		{
-			frames = loadedFrames;
-			UpdateFrameCount();
-		}
-
-		if(makeMasks)
+		loaded.assign(loaded.size(), true);
+		frames = buffer[0].Frames();
+		UpdateFrameCount();
+	}
+	else
+	{
+		ReadFrames(buffer[0], paths[0].size(), [&](size_t i)
 		{
-			masks[i].Create(buffer[0], i, fileName);
-			if(!masks[i].IsLoaded())
-				Logger::Log("Failed to create collision mask for " + fileName, Logger::Level::WARNING);
-		}
+			// Only the first frame that is read can be an image sequence, since image
+			// sequences are exclusive. So this never changes the frame count while
+			// other frames are being read.
+			int loadedFrames = buffer[0].Read(paths[0][i], i);
+			if(!loadedFrames)
+			{
+				Logger::Log("Failed to read image data for \"" + name + "\" frame #" + to_string(i),
+					Logger::Level::WARNING);
+				return;
+			}
+			loaded[i] = true;
+			// If we loaded an image sequence, clear all other buffers.
+			if(loadedFrames > 1)
+			{
+				frames = loadedFrames;
+				UpdateFrameCount();
+			}
+		});
+		if(imageCache && all_of(loaded.begin(), loaded.end(), [](char isLoaded) { return isLoaded; }))
+			imageCache->Save(name, 0, fileKeys[0], buffer[0]);
 	}
 
-	auto LoadSprites = [&](const vector<filesystem::path> &toLoad, ImageBuffer &buffer, const string &specifier)
+	// Once all the frames are in, create the masks if needed. Tracing them is
+	// slow, so if none of the frames has changed, use the cached masks instead.
+	if(makeMasks && !(maskCache && maskCache->Load(name, fileKeys[0], masks)))
 	{
-		for(size_t i = 0; i < frames && i < toLoad.size(); ++i)
-			if(!buffer.Read(toLoad[i], i))
+		TaskQueue queue;
+		queue.ParallelFor(loaded.size(), 1, [this, &loaded](size_t begin, size_t end)
+		{
+			for(size_t i = begin; i < end; ++i)
 			{
-				Logger::Log("Removing " + specifier + " frames for \"" + name + "\" due to read error",
-					Logger::Level::WARNING);
-				buffer.Clear();
-				break;
+				if(!loaded[i])
+					continue;
+				const string fileName = "\"" + name + "\" frame #" + to_string(i);
+				masks[i].Create(buffer[0], i, fileName);
+				if(!masks[i].IsLoaded())
+					Logger::Log("Failed to create collision mask for " + fileName, Logger::Level::WARNING);
 			}
+		});
+		if(maskCache)
+			maskCache->Save(name, fileKeys[0], masks);
+	}
+
+	auto LoadSprites = [&](int variant, const string &specifier)
+	{
+		const vector<filesystem::path> &toLoad = paths[variant];
+		ImageBuffer &variantBuffer = buffer[variant];
+		if(imageCache && imageCache->Load(name, variant, fileKeys[variant], variantBuffer))
+			return;
+
+		atomic<bool> failed = false;
+		ReadFrames(variantBuffer, min(frames, toLoad.size()), [&](size_t i)
+		{
+			if(!failed && !variantBuffer.Read(toLoad[i], i))
+				failed = true;
+		});
+		if(failed)
+		{
+			Logger::Log("Removing " + specifier + " frames for \"" + name + "\" due to read error",
+				Logger::Level::WARNING);
+			variantBuffer.Clear();
+		}
+		else if(imageCache)
+			imageCache->Save(name, variant, fileKeys[variant], variantBuffer);
 	};
 	// Now, load the mask and 2x sprites, if they exist. Because the number of 1x frames
 	// is definitive, don't load any frames beyond the size of the 1x list.
-	LoadSprites(paths[1], buffer[1], "@2x");
-	LoadSprites(paths[2], buffer[2], "mask");
-	LoadSprites(paths[3], buffer[3], "@2x mask");
+	LoadSprites(1, "@2x");
+	LoadSprites(2, "mask");
+	LoadSprites(3, "@2x mask");
 
 	// Warn about a "high-profile" image that will be blurry due to rendering at 50% scale.
 	bool willBlur = (buffer[0].Width() & 1) || (buffer[0].Height() & 1);
@@ -22,8 +22,10 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <string>
 #include <vector>
 
+class ImageCache;
 class ImageFileData;
 class Mask;
+class MaskCache;
 class Sprite;
 
 
@@ -52,8 +54,9 @@ public:
 	// Reduce all given paths to frame images into a sequence of consecutive frames.
 	void ValidateFrames() noexcept(false);
 	// Load all the frames. This should be called in one of the image-loading
-	// worker threads. This also generates collision masks if needed.
-	void Load() noexcept(false);
+	// worker threads. This also generates collision masks if needed. If any
+	// caches are given, the frames and masks are taken from them if possible.
+	void Load(MaskCache *maskCache = nullptr, ImageCache *imageCache = nullptr) noexcept(false);
 	// Load only the dimensions of the sprite. This loads the first frame of the 1x resolution sprite and
 	// records the dimensions. Load() + Upload() also records the dimensions, so this should only be used
 	// on sprites with deferred loading.
@@ -34,6 +34,8 @@ class Mask {
 public:
 	// Construct a mask from the alpha channel of an RGBA-formatted image.
 	void Create(const ImageBuffer &image, int frame, const std::string &fileName);
+	// Construct a mask from outlines that were created from an image earlier.
+	void Create(std::vector<std::vector<Point>> outlines);
 
 	// Check whether a mask was successfully generated from the image.
 	bool IsLoaded() const;
@@ -0,0 +1,128 @@
+/* MaskCache.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "MaskCache.h"
+
+#include "../BinaryData.h"
+#include "Mask.h"
+#include "../MappedFile.h"
+#include "../Point.h"
+
+#include <cstdint>
+
+using namespace std;
+
+namespace {
+	// The cached masks start with this, followed by a version number that
+	// must be changed whenever the way masks are stored or created changes.
+	const uint32_t BINARY_MAGIC = 0x4B534D45;
+	const uint32_t BINARY_VERSION = 1;
+}
+
+
+
+// Keep the cached masks in the given directory. If it cannot be created,
+// masks are always traced.
+MaskCache::MaskCache(const filesystem::path &directory)
+	: folder(directory)
+{
+}
+
+
+
+// Load the cached masks of the given sprite, if they match the given key
+// and there are as many of them as the given vector holds. The key should
+// be the CacheFolder::FileKey() of the sprite's frames; if it is empty,
+// nothing is cached.
+bool MaskCache::Load(const string &name, const string &key, vector<Mask> &masks)
+{
+	if(key.empty() || !folder.IsEnabled())
+		return false;
+
+	MappedFile cached(folder.Use(name));
+	BinaryReader in(cached.View());
+	if(in.Read<uint32_t>() != BINARY_MAGIC || in.Read<uint32_t>() != BINARY_VERSION || in.ReadText() != key
+			|| in.Read<uint64_t>() != masks.size())
+		return false;
+
+	vector<Mask> loaded(masks.size());
+	for(Mask &mask : loaded)
+	{
+		uint64_t outlineCount = in.Read<uint64_t>();
+		if(!outlineCount || !in.HasRoom(outlineCount, sizeof(uint64_t)))
+			return false;
+		vector<vector<Point>> outlines(outlineCount);
+		for(vector<Point> &outline : outlines)
+		{
+			uint64_t pointCount = in.Read<uint64_t>();
+			// Outlines with no area are never kept in a mask.
+			if(pointCount <= 2 || !in.HasRoom(pointCount, 2 * sizeof(double)))
+				return false;
+			outline.reserve(pointCount);
+			for(uint64_t i = 0; i < pointCount; ++i)
+			{
+				double x = in.Read<double>();
+				double y = in.Read<double>();
+				outline.emplace_back(x, y);
+			}
+		}
+		mask.Create(std::move(outlines));
+	}
+	if(!in.IsValid() || !in.AtEnd())
+		return false;
+
+	masks = std::move(loaded);
+	return true;
+}
+
+
+
+// Cache the masks of the given sprite, unless any of them is not loaded.
+void MaskCache::Save(const string &name, const string &key, const vector<Mask> &masks)
+{
+	if(key.empty() || !folder.IsEnabled())
+		return;
+	for(const Mask &mask : masks)
+		if(!mask.IsLoaded())
+			return;
+
+	BinaryWriter out;
+	out.Write(BINARY_MAGIC);
+	out.Write(BINARY_VERSION);
+	out.WriteText(key);
+	out.Write<uint64_t>(masks.size());
+	for(const Mask &mask : masks)
+	{
+		out.Write<uint64_t>(mask.Outlines().size());
+		for(const vector<Point> &outline : mask.Outlines())
+		{
+			out.Write<uint64_t>(outline.size());
+			for(const Point &point : outline)
+			{
+				out.Write(point.X());
+				out.Write(point.Y());
+			}
+		}
+	}
+	folder.Write(folder.Use(name), out.Data());
+}
+
+
+
+// Delete any cached masks that were not used since this cache was created.
+void MaskCache::RemoveUnused() const
+{
+	folder.RemoveUnused();
+}
@@ -0,0 +1,54 @@
+/* MaskCache.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "../CacheFolder.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+class Mask;
+
+
+
+// A MaskCache keeps the collision masks of sprites on disk, so that they do not
+// have to be traced again from the images each time the game starts. The masks
+// of each sprite are cached along with the path, size, modification time and a
+// hash of the contents of each of its frames; if any of those differ, the masks
+// are traced again. Sprites for which any mask could not be created are never
+// cached, so that the warnings about them are shown every time. Masks can be
+// loaded and saved from several threads at once.
+class MaskCache {
+public:
+	// Keep the cached masks in the given directory. If it cannot be created,
+	// masks are always traced.
+	explicit MaskCache(const std::filesystem::path &directory);
+
+	// Load the cached masks of the given sprite, if they match the given key
+	// and there are as many of them as the given vector holds. The key should
+	// be the CacheFolder::FileKey() of the sprite's frames; if it is empty,
+	// nothing is cached.
+	bool Load(const std::string &name, const std::string &key, std::vector<Mask> &masks);
+	// Cache the masks of the given sprite, unless any of them is not loaded.
+	void Save(const std::string &name, const std::string &key, const std::vector<Mask> &masks);
+	// Delete any cached masks that were not used since this cache was created.
+	void RemoveUnused() const;
+
+
+private:
+	CacheFolder folder;
+};
@@ -23,11 +23,20 @@ using namespace std;
 namespace {
 	const Point DEFAULT = Point(1., 1.);
 	map<const Sprite *, bool> warned;
+	mutex warnedMutex;
 
 	string PrintScale(Point s)
 	{
 		return to_string(100. * s.X()) + "x" + to_string(100. * s.Y()) + "%";
 	}
+
+	// Check if this is the first time a warning is given for the given sprite.
+	// Only called when a lookup fails, so the lock does not slow down lookups.
+	bool ShouldWarn(const Sprite *sprite)
+	{
+		lock_guard<mutex> lock(warnedMutex);
+		return warned.insert(make_pair(sprite, true)).second;
+	}
 }
 
 
@@ -42,6 +51,7 @@ void MaskManager::SetMasks(const Sprite *sprite, vector<Mask> &&masks)
 		it->second.swap(masks);
 	else
 		scales.emplace(DEFAULT, std::move(masks));
+	++generation;
 }
 
 
@@ -53,7 +63,10 @@ void MaskManager::RegisterScale(const Sprite *sprite, Point scale)
 	auto &scales = spriteMasks[sprite];
 	auto lb = scales.lower_bound(scale);
 	if(lb == scales.end() || lb->first != scale)
+	{
 		scales.emplace_hint(lb, scale, vector<Mask>{});
+		++generation;
+	}
 	else if(!lb->second.empty())
 		Logger::Log("Collision mask for sprite \"" + sprite->Name() + "\" at scale "
 			+ PrintScale(scale) + " was already generated.", Logger::Level::WARNING);
@@ -64,6 +77,7 @@ void MaskManager::RegisterScale(const Sprite *sprite, Point scale)
 // Create the scaled versions of all masks from the 1x versions.
 void MaskManager::ScaleMasks()
 {
+	lock_guard<mutex> lock(spriteMutex);
 	for(auto &spriteScales : spriteMasks)
 	{
 		auto &scales = spriteScales.second;
@@ -85,19 +99,22 @@ void MaskManager::ScaleMasks()
 				masks.push_back(mask * it.first);
 		}
 	}
+	++generation;
 }
 
 
 
 // Get the masks for the given sprite at the given scale. If a
-// sprite has no masks, an empty mask is returned.
+// sprite has no masks, an empty mask is returned. Once ScaleMasks() has
+// run, the stored masks only change while data is being loaded, so this
+// takes no lock and may be called from several threads at once.
 const vector<Mask> &MaskManager::GetMasks(const Sprite *sprite, Point scale) const
 {
 	static const vector<Mask> EMPTY;
 	const auto scalesIt = spriteMasks.find(sprite);
 	if(scalesIt == spriteMasks.end())
 	{
-		if(warned.insert(make_pair(sprite, true)).second)
+		if(ShouldWarn(sprite))
 			Logger::Log("Sprite \"" + sprite->Name() + "\": no collision masks found.", Logger::Level::WARNING);
 		return EMPTY;
 	}
@@ -108,7 +125,7 @@ const vector<Mask> &MaskManager::GetMasks(const Sprite *sprite, Point scale) con
 		return maskIt->second;
 
 	// Shouldn't happen, but just in case, print some details about the scales for this sprite (once).
-	if(warned.insert(make_pair(sprite, true)).second)
+	if(ShouldWarn(sprite))
 	{
 		string warning = "Sprite \"" + sprite->Name() + "\": collision mask not found.";
 		if(scales.empty()) warning += " (No scaled masks.)";
@@ -126,6 +143,15 @@ const vector<Mask> &MaskManager::GetMasks(const Sprite *sprite, Point scale) con
 
 
 
+// Get a number that changes whenever the stored masks change. A reference
+// returned by GetMasks() may be kept for as long as this stays the same.
+unsigned MaskManager::Generation() const
+{
+	return generation.load(memory_order_acquire);
+}
+
+
+
 bool MaskManager::Cmp::operator()(const Point &a, const Point &b) const noexcept
 {
 	return a.LengthSquared() < b.LengthSquared();
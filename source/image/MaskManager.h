@@ -17,6 +17,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "Mask.h"
 
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <vector>
@@ -40,8 +41,13 @@ public:
 	void ScaleMasks();
 
 	// Get the masks for the given sprite at the given scale. If a
-	// sprite has no masks, an empty mask is returned.
+	// sprite has no masks, an empty mask is returned. Once ScaleMasks() has
+	// run, the stored masks only change while data is being loaded, so this
+	// takes no lock and may be called from several threads at once.
 	const std::vector<Mask> &GetMasks(const Sprite *sprite, Point scale) const;
+	// Get a number that changes whenever the stored masks change. A reference
+	// returned by GetMasks() may be kept for as long as this stays the same.
+	unsigned Generation() const;
 
 
 private:
@@ -54,4 +60,5 @@ private:
 
 	// Mutex to make sure different threads don't modify the masks at the same time.
 	std::mutex spriteMutex;
+	std::atomic<unsigned> generation = 0;
 };
@@ -27,8 +27,10 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 using namespace std;
 
 namespace {
-	void AddBuffer(const string &name, ImageBuffer &buffer, uint32_t *target, bool noReduction)
+	// Upload the buffer as a texture, and return how many bytes of video memory it takes up.
+	size_t AddBuffer(const string &name, ImageBuffer &buffer, uint32_t *target, bool noReduction)
 	{
+		size_t bytes = 0;
 		// Check whether this sprite is large enough to require size reduction.
 		Preferences::LargeGraphicsReduction setting = Preferences::GetLargeGraphicsReduction();
 		if(!noReduction && (setting == Preferences::LargeGraphicsReduction::ALL
@@ -86,6 +88,7 @@ namespace {
 			glTexImage3D(type, 0, GL_RGBA8, // target, mipmap level, internal format,
 				buffer.Width(), buffer.Height(), buffer.Frames(), // width, height, depth,
 				0, GL_RGBA, GL_UNSIGNED_BYTE, buffer.Pixels()); // border, input format, data type, data.
+			bytes = sizeof(uint32_t) * buffer.Width() * buffer.Height() * buffer.Frames();
 #ifndef ES_GLES
 		}
 		else
@@ -99,6 +102,7 @@ namespace {
 
 		// Free the ImageBuffer memory.
 		buffer.Clear();
+		return bytes;
 	}
 }
 
@@ -151,11 +155,11 @@ void Sprite::AddFrames(ImageBuffer &buffer1x, ImageBuffer &buffer2x, bool noRedu
 	// Only use the 2x resolution image if it is provided.
 	if(buffer2x.Pixels())
 	{
-		AddBuffer(name, buffer2x, &texture, noReduction);
+		memoryUsage += AddBuffer(name, buffer2x, &texture, noReduction);
 		buffer1x.Clear();
 	}
 	else
-		AddBuffer(name, buffer1x, &texture, noReduction);
+		memoryUsage += AddBuffer(name, buffer1x, &texture, noReduction);
 }
 
 
@@ -177,11 +181,11 @@ void Sprite::AddSwizzleMaskFrames(ImageBuffer &buffer1x, ImageBuffer &buffer2x,
 	// Only use the 2x resolution image if it is provided.
 	if(buffer2x.Pixels())
 	{
-		AddBuffer(name, buffer2x, &swizzleMask, noReduction);
+		memoryUsage += AddBuffer(name, buffer2x, &swizzleMask, noReduction);
 		buffer1x.Clear();
 	}
 	else
-		AddBuffer(name, buffer1x, &swizzleMask, noReduction);
+		memoryUsage += AddBuffer(name, buffer1x, &swizzleMask, noReduction);
 }
 
 
@@ -207,11 +211,20 @@ void Sprite::Unload()
 		swizzleMask = 0;
 	}
 	isLoaded = false;
+	memoryUsage = 0;
 	// Dimension and frame information is retained.
 }
 
 
 
+// Get how many bytes of video memory the uploaded textures take up.
+size_t Sprite::MemoryUsage() const
+{
+	return memoryUsage;
+}
+
+
+
 // Get the width, in pixels, of the 1x image.
 float Sprite::Width() const
 {
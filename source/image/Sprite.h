@@ -17,6 +17,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "../Point.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -50,6 +51,8 @@ public:
 	bool IsLoaded() const;
 	// Free up all textures loaded for this sprite.
 	void Unload();
+	// The number of bytes of video memory taken up by this sprite's textures.
+	size_t MemoryUsage() const;
 
 	// Image dimensions, in pixels.
 	float Width() const;
@@ -75,6 +78,7 @@ private:
 	uint32_t texture{};
 	uint32_t swizzleMask{};
 	bool isLoaded = false;
+	size_t memoryUsage = 0;
 
 	float width = 0.f;
 	float height = 0.f;
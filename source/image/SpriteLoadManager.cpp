@@ -15,16 +15,25 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "SpriteLoadManager.h"
 
+#include "../Files.h"
+#include "ImageCache.h"
 #include "ImageSet.h"
+#include "MaskCache.h"
 #include "../Preferences.h"
 #include "Sprite.h"
 #include "SpriteSet.h"
 #include "../TaskQueue.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <set>
+#include <system_error>
+#include <vector>
 
 using namespace std;
 
@@ -40,11 +49,18 @@ namespace {
 	// List of image sets that are waiting to be loaded at game start.
 	mutex imageQueueMutex;
 	queue<shared_ptr<ImageSet>> imageQueue;
+	// The collision masks that were traced the last time the game started.
+	unique_ptr<MaskCache> maskCache;
+	// The frames that were decoded the last time the game started, if enabled.
+	unique_ptr<ImageCache> imageCache;
 
 	// The root folders (starting from the images folder) that use deferred loading.
 	set<string> deferredFolders;
 	// The sprites that use deferred loading.
 	map<const Sprite *, shared_ptr<ImageSet>> deferred;
+	// Deferred sprites are requested by the engine's calculation thread, but loaded and unloaded on the
+	// main thread. This guards all the records below of which sprites are loaded.
+	mutex loadedMutex;
 	// Up to 20 landscape images will be preloaded at a time, with the oldest being culled to make room for new ones.
 	const int LANDSCAPE_LIMIT = 20;
 	map<const Sprite *, int> preloadedLandscapes;
@@ -56,6 +72,24 @@ namespace {
 	// Scenes remain loaded for only one in-game day before they're culled, as they are not commonly requested.
 	// Most scenes are only ever used in a single conversation, for example.
 	set<const Sprite *> loadedScenes;
+	// All deferred sprites that are loaded or being loaded, with the priority they were requested with
+	// and the order in which they were last requested. This is used to keep the deferred sprites within
+	// the video memory limit set by the player.
+	struct Residency {
+		SpriteLoadManager::Priority priority = SpriteLoadManager::Priority::MAP;
+		uint64_t lastUse = 0;
+	};
+	map<const Sprite *, Residency> resident;
+	uint64_t useCount = 0;
+	// The value of useCount when images were last culled.
+	uint64_t lastCull = 0;
+	// How many map panels are open, and the value of useCount when the first of them opened.
+	int mapPanels = 0;
+	uint64_t mapOpened = 0;
+	// The most video memory that sprites loaded ahead of time may take up at once. If the player limited the
+	// memory used by deferred sprites, prefetching only uses part of that, so it does not push out the sprites
+	// that are on screen.
+	const size_t PREFETCH_BUDGET = 64 << 20;
 	// Missions and events can add new sprites to the player's current area that may need to be loaded.
 	// The code that makes these changes may not have access to the TaskQueue in UI, so they
 	// instead send a message to the SpriteLoadManager to tell the current Panel to recheck which
@@ -73,9 +107,10 @@ namespace {
 		return deferredFolders.contains(pathStart.string());
 	}
 
-	// Loads a sprite and queues it for upload to the GPU.
+	// Unloads a sprite that uses deferred loading. The caller must hold the lock on the loaded sprites.
 	void UnloadSprite(TaskQueue &queue, const Sprite *sprite)
 	{
+		resident.erase(sprite);
 		// Don't unload sprites if they were never uploaded to begin with.
 		if(preventSpriteUpload)
 			return;
@@ -83,6 +118,81 @@ namespace {
 		queue.Run({}, [name = sprite->Name()] { SpriteSet::Modify(name)->Unload(); });
 	}
 
+	// Check whether the given sprite may be unloaded to make room for others. The sprites of the
+	// current system are never unloaded, and neither are those that an open map panel asked for.
+	bool CanEvict(const Sprite *sprite, const Residency &residency)
+	{
+		if(!sprite->IsLoaded() || residency.priority == SpriteLoadManager::Priority::CURRENT)
+			return false;
+		return !mapPanels || residency.priority != SpriteLoadManager::Priority::MAP || residency.lastUse <= mapOpened;
+	}
+
+	// If the deferred sprites take up more video memory than allowed, unload the least important
+	// ones until they fit. The sprite that was just uploaded is never unloaded, since it was
+	// asked for just now.
+	void EnforceMemoryLimit(const Sprite *uploaded)
+	{
+		const size_t limit = Preferences::ImageMemoryLimit();
+		if(!limit)
+			return;
+
+		lock_guard lock(loadedMutex);
+		size_t total = 0;
+		for(const auto &it : resident)
+			total += it.first->MemoryUsage();
+		while(total > limit)
+		{
+			auto victim = resident.end();
+			for(auto it = resident.begin(); it != resident.end(); ++it)
+			{
+				const Residency &residency = it->second;
+				if(it->first == uploaded || !CanEvict(it->first, residency))
+					continue;
+				if(victim == resident.end() || residency.priority < victim->second.priority
+						|| (residency.priority == victim->second.priority
+							&& residency.lastUse < victim->second.lastUse))
+					victim = it;
+			}
+			if(victim == resident.end())
+				break;
+
+			const Sprite *sprite = victim->first;
+			total -= sprite->MemoryUsage();
+			resident.erase(victim);
+			preloadedLandscapes.erase(sprite);
+			loadedStellarObjects.erase(sprite);
+			loadedThumbnails.erase(sprite);
+			loadedScenes.erase(sprite);
+			// This is already running on the main thread.
+			SpriteSet::Modify(sprite->Name())->Unload();
+		}
+	}
+
+	// Loads a sprite that uses deferred loading and queues it for upload to the GPU.
+	void LoadResident(TaskQueue &queue, const shared_ptr<ImageSet> &image)
+	{
+		queue.Run([image] { image->Load(maskCache.get(), imageCache.get()); },
+			[image]
+			{
+				Sprite *sprite = SpriteSet::Modify(image->Name());
+				image->Upload(sprite, !preventSpriteUpload);
+				EnforceMemoryLimit(sprite);
+			});
+	}
+
+	// Count a sprite as loaded at game start. Once every sprite has been loaded,
+	// any cached masks or frames that were not used belong to sprites that no
+	// longer exist.
+	void CountLoadedSprite()
+	{
+		if(++spritesLoaded == totalSprites && queuedAllImages)
+		{
+			maskCache->RemoveUnused();
+			if(imageCache)
+				imageCache->RemoveUnused();
+		}
+	}
+
 	// Functions for queueing the loading of sprites at game start.
 	void LoadSpriteQueued(TaskQueue &queue, const shared_ptr<ImageSet> &image);
 	// Loads a sprite from the image queue, recursively.
@@ -108,7 +218,7 @@ namespace {
 			queue.Run([image, sprite] { image->LoadDimensions(sprite); },
 				[&queue]
 				{
-					++spritesLoaded;
+					CountLoadedSprite();
 					// Start loading the next image in the queue, if any.
 					lock_guard lock(imageQueueMutex);
 					LoadSpriteQueued(queue);
@@ -116,11 +226,11 @@ namespace {
 		}
 		else
 		{
-			queue.Run([image] { image->Load(); },
+			queue.Run([image] { image->Load(maskCache.get(), imageCache.get()); },
 				[image, sprite, &queue]
 				{
 					image->Upload(sprite, !preventSpriteUpload);
-					++spritesLoaded;
+					CountLoadedSprite();
 
 					// Start loading the next image in the queue, if any.
 					lock_guard lock(imageQueueMutex);
@@ -134,6 +244,18 @@ namespace {
 
 void SpriteLoadManager::Init(TaskQueue &queue, map<string, shared_ptr<ImageSet>> images)
 {
+	maskCache = make_unique<MaskCache>(Files::Config() / "mask cache");
+	// Decoded frames take up a lot of disk space, so they are only cached if
+	// the player asked for it. Otherwise, free up the space of any earlier cache.
+	const filesystem::path imageCachePath = Files::Config() / "image cache";
+	if(Preferences::Has("Cache decoded images"))
+		imageCache = make_unique<ImageCache>(imageCachePath);
+	else
+	{
+		error_code error;
+		filesystem::remove_all(imageCachePath, error);
+	}
+
 	// From the name, strip out any frame number, plus the extension.
 	for(auto &[name, imageSet] : images)
 	{
@@ -143,9 +265,14 @@ void SpriteLoadManager::Init(TaskQueue &queue, map<string, shared_ptr<ImageSet>>
 
 		// Reduce the set of images to those that are valid.
 		imageSet->ValidateFrames();
-		// Keep track of which images should use deferred loading.
+		// Keep track of which images should use deferred loading. Their cached
+		// frames are kept, even though they are not loaded at game start.
 		if(IsDeferredFolder(name))
+		{
 			deferred[SpriteSet::Get(name)] = imageSet;
+			if(imageCache)
+				imageCache->Keep(name);
+		}
 		lock_guard lock(imageQueueMutex);
 		imageQueue.push(std::move(imageSet));
 		++totalSprites;
@@ -198,7 +325,7 @@ double SpriteLoadManager::Progress()
 
 void SpriteLoadManager::LoadSprite(TaskQueue &queue, const shared_ptr<ImageSet> &image)
 {
-	queue.Run([image] { image->Load(); },
+	queue.Run([image] { image->Load(maskCache.get(), imageCache.get()); },
 		[image] { image->Upload(SpriteSet::Modify(image->Name()), !preventSpriteUpload); });
 }
 
@@ -211,29 +338,50 @@ bool SpriteLoadManager::IsDeferred(const Sprite *sprite)
 
 
 
-void SpriteLoadManager::LoadDeferred(TaskQueue &queue, const Sprite *sprite)
+void SpriteLoadManager::LoadDeferred(TaskQueue &queue, const Sprite *sprite, Priority priority)
 {
 	// Make sure this sprite actually is one that uses deferred loading.
 	auto dit = deferred.find(sprite);
 	if(!sprite || dit == deferred.end())
 		return;
 
-	const string &name = sprite->Name();
-	const shared_ptr<ImageSet> &image = dit->second;
-	if(name.starts_with("land/"))
-		LoadLandscape(queue, sprite, image);
-	else if(name.starts_with("thumbnail/") || name.starts_with("outfit/"))
-		LoadThumbnail(queue, sprite, image);
-	else if(name.starts_with("star/") || name.starts_with("planet/"))
-		LoadStellarObject(queue, sprite, image);
-	else if(name.starts_with("scene/"))
-		LoadScene(queue, sprite, image);
+	lock_guard lock(loadedMutex);
+	Request(queue, sprite, dit->second, priority);
+}
+
+
+
+void SpriteLoadManager::Prefetch(TaskQueue &queue, const vector<const Sprite *> &sprites)
+{
+	size_t budget = PREFETCH_BUDGET;
+	const size_t limit = Preferences::ImageMemoryLimit();
+	if(limit)
+		budget = min(budget, limit / 4);
+
+	lock_guard lock(loadedMutex);
+	for(const Sprite *sprite : sprites)
+	{
+		auto dit = deferred.find(sprite);
+		if(!sprite || dit == deferred.end())
+			continue;
+		// Sprites that are already loaded or being loaded cost nothing extra. For the others,
+		// estimate the size from the 1x dimensions, which are known without loading the sprite.
+		if(!resident.contains(sprite))
+		{
+			const size_t bytes = static_cast<size_t>(sprite->Width() * sprite->Height()) * sprite->Frames() * 4;
+			if(bytes > budget)
+				break;
+			budget -= bytes;
+		}
+		Request(queue, sprite, dit->second, Priority::NEIGHBOR);
+	}
 }
 
 
 
 void SpriteLoadManager::CullOldImages(TaskQueue &queue)
 {
+	lock_guard lock(loadedMutex);
 	auto Cull = [&queue](map<const Sprite *, int> &loadedSprites) -> void {
 		for(auto it = loadedSprites.begin(); it != loadedSprites.end(); )
 		{
@@ -254,6 +402,30 @@ void SpriteLoadManager::CullOldImages(TaskQueue &queue)
 	for(const Sprite *sprite : loadedScenes)
 		UnloadSprite(queue, sprite);
 	loadedScenes.clear();
+
+	// Sprites that were not asked for since the last cull are less likely to be needed again,
+	// e.g. those of the system the flagship just left.
+	for(auto &it : resident)
+		if(it.second.lastUse <= lastCull && it.second.priority != Priority::MAP)
+			it.second.priority = static_cast<Priority>(static_cast<int>(it.second.priority) - 1);
+	lastCull = useCount;
+}
+
+
+
+void SpriteLoadManager::KeepMapSprites()
+{
+	lock_guard lock(loadedMutex);
+	if(!mapPanels++)
+		mapOpened = useCount;
+}
+
+
+
+void SpriteLoadManager::ReleaseMapSprites()
+{
+	lock_guard lock(loadedMutex);
+	--mapPanels;
 }
 
 
@@ -291,6 +463,27 @@ bool SpriteLoadManager::RecheckStellarObjects()
 
 
 
+void SpriteLoadManager::Request(TaskQueue &queue, const Sprite *sprite, const shared_ptr<ImageSet> &image,
+	Priority priority)
+{
+	// Make note of how important this sprite is now, and that it was the most recently asked-for one.
+	Residency &residency = resident[sprite];
+	residency.priority = max(residency.priority, priority);
+	residency.lastUse = ++useCount;
+
+	const string &name = sprite->Name();
+	if(name.starts_with("land/"))
+		LoadLandscape(queue, sprite, image);
+	else if(name.starts_with("thumbnail/") || name.starts_with("outfit/"))
+		LoadThumbnail(queue, sprite, image);
+	else if(name.starts_with("star/") || name.starts_with("planet/"))
+		LoadStellarObject(queue, sprite, image);
+	else if(name.starts_with("scene/"))
+		LoadScene(queue, sprite, image);
+}
+
+
+
 void SpriteLoadManager::LoadLandscape(TaskQueue &queue, const Sprite *sprite, const shared_ptr<ImageSet> &image)
 {
 	// If this sprite is one of the currently loaded ones, there is no need to
@@ -325,7 +518,7 @@ void SpriteLoadManager::LoadLandscape(TaskQueue &queue, const Sprite *sprite, co
 
 	// Now, load all the files for this sprite.
 	preloadedLandscapes[sprite] = 0;
-	LoadSprite(queue, image);
+	LoadResident(queue, image);
 }
 
 
@@ -339,7 +532,7 @@ void SpriteLoadManager::LoadStellarObject(TaskQueue &queue, const Sprite *sprite
 		return;
 	}
 	loadedStellarObjects[sprite] = 0;
-	LoadSprite(queue, image);
+	LoadResident(queue, image);
 }
 
 
@@ -353,7 +546,7 @@ void SpriteLoadManager::LoadThumbnail(TaskQueue &queue, const Sprite *sprite, co
 		return;
 	}
 	loadedThumbnails[sprite] = 0;
-	LoadSprite(queue, image);
+	LoadResident(queue, image);
 }
 
 
@@ -363,5 +556,5 @@ void SpriteLoadManager::LoadScene(TaskQueue &queue, const Sprite *sprite, const
 	if(!loadedScenes.insert(sprite).second)
 		return;
 
-	LoadSprite(queue, image);
+	LoadResident(queue, image);
 }
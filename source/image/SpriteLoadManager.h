@@ -18,6 +18,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 class ImageSet;
 class PlayerInfo;
@@ -30,6 +31,18 @@ class TaskQueue;
 // for managing the loading and unloading of sprites that use deferred loading.
 class SpriteLoadManager {
 public:
+	// How important it is to keep a sprite that uses deferred loading in memory.
+	// If the deferred images take up more video memory than the player allows,
+	// the least important and least recently requested ones are unloaded first.
+	enum class Priority : int {
+		// Sprites only shown in the map.
+		MAP,
+		// Sprites of systems that the player may travel to soon.
+		NEIGHBOR,
+		// Sprites of the flagship's system, and anything else that is on screen.
+		CURRENT
+	};
+
 	static void Init(TaskQueue &queue, std::map<std::string, std::shared_ptr<ImageSet>> images);
 	static void PreventSpriteUpload();
 	static void FindDeferredFolders();
@@ -42,9 +55,18 @@ public:
 	static bool IsDeferred(const Sprite *sprite);
 	// Begin loading a sprite that was previously deferred. This is done for various images to speed up
 	// the program's startup and reduce VRAM usage.
-	static void LoadDeferred(TaskQueue &queue, const Sprite *sprite);
-	// Cull old stellar objects and thumbnails that haven't been seen in a while.
+	static void LoadDeferred(TaskQueue &queue, const Sprite *sprite, Priority priority = Priority::CURRENT);
+	// Begin loading the given deferred sprites ahead of time, because the player is likely to see them soon.
+	// They are loaded in the given order until their estimated size exceeds the prefetching budget.
+	static void Prefetch(TaskQueue &queue, const std::vector<const Sprite *> &sprites);
+	// Cull old stellar objects and thumbnails that haven't been seen in a while,
+	// and lower the priority of the sprites that were not requested since the last cull.
 	static void CullOldImages(TaskQueue &queue);
+	// While a map panel is open, the sprites it asks for are never unloaded to stay within the video memory
+	// limit, because the panel only asks for them once. Each call to KeepMapSprites() must be matched by a
+	// call to ReleaseMapSprites() once the panel closes.
+	static void KeepMapSprites();
+	static void ReleaseMapSprites();
 
 	// Changes can be made by missions or events that cause new assets to appear.
 	// When this happens, a class can signal to the SpriteLoadManager than a panel
@@ -56,6 +78,10 @@ public:
 
 
 private:
+	// Note that the given deferred sprite was asked for, and load it if it is not loaded yet.
+	// The caller must hold the lock on the loaded sprites.
+	static void Request(TaskQueue &queue, const Sprite *sprite, const std::shared_ptr<ImageSet> &image,
+		Priority priority);
 	// Preload a landscape image. If 20 landscape images have already been preloaded
 	// previously, unload the least recently seen image.
 	static void LoadLandscape(TaskQueue &queue, const Sprite *sprite, const std::shared_ptr<ImageSet> &image);
@@ -41,11 +41,14 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "PluginManager.h"
 #include "Preferences.h"
 #include "PrintData.h"
+#include "Profiler.h"
 #include "Random.h"
 #include "Screen.h"
+#include "image/MaskManager.h"
 #include "image/SpriteSet.h"
 #include "shader/SpriteShader.h"
 #include "TaskQueue.h"
+#include "test/Benchmark.h"
 #include "test/Test.h"
 #include "test/TestContext.h"
 #include "UI.h"
@@ -59,10 +62,12 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <chrono>
 #include <iostream>
 #include <map>
+#include <sstream>
 
 #include <cassert>
 #include <future>
 #include <exception>
+#include <filesystem>
 #include <string>
 
 #ifdef _WIN32
@@ -87,9 +92,11 @@ using namespace std;
 void PrintHelp();
 void PrintVersion();
 void GameLoop(PlayerInfo &player, TaskQueue &queue, const Conversation &conversation,
-	const string &testToRun, bool debugMode);
+	const string &testToRun, bool debugMode, const filesystem::path &profilePath);
 Conversation LoadConversation(const PlayerInfo &player);
 void PrintTestsTable();
+void WriteProfile(const filesystem::path &path);
+bool RunBenchmarks(TaskQueue &queue, const filesystem::path &path);
 
 
 
@@ -112,6 +119,8 @@ int main(int argc, char *argv[])
 	bool noTestMute = false;
 	uint64_t nWorkerThreads = 0;
 	string testToRunName;
+	string benchmarkPath;
+	filesystem::path profilePath;
 
 	// Whether the game has encountered errors while loading.
 	bool hasErrors = false;
@@ -147,6 +156,10 @@ int main(int argc, char *argv[])
 			testToRunName = *it;
 		else if(arg == "--tests")
 			printTests = true;
+		else if(arg == "--benchmark" && *++it)
+			benchmarkPath = *it;
+		else if(arg == "--profile" && *++it)
+			profilePath = *it;
 		else if(arg == "--nomute")
 			noTestMute = true;
 		else if(arg == "--rngseed" && *++it)
@@ -157,14 +170,20 @@ int main(int argc, char *argv[])
 
 	if(nWorkerThreads)
 		TaskQueue::SetWorkerThreadCount(nWorkerThreads);
+	// In debug mode, the profile can be written at any time with a key press.
+	if(debugMode || !profilePath.empty())
+		Profiler::SetEnabled(true);
 	printData = PrintData::IsPrintDataArgument(argv);
 	Files::Init(argv);
 
 	// Whether we are running an integration test.
 	const bool isTesting = !testToRunName.empty();
+	// Whether we are running a benchmark, which needs the collision masks
+	// of the sprites but never draws anything.
+	const bool isBenchmark = !benchmarkPath.empty();
 	bool isConsoleOnly = loadOnly || printTests || printData;
 
-	Logger::Session logSession{isConsoleOnly || isTesting};
+	Logger::Session logSession{isConsoleOnly || isTesting || isBenchmark};
 
 	try {
 		// Load plugin settings and preferences before game data.
@@ -175,11 +194,11 @@ int main(int argc, char *argv[])
 
 		// Begin loading the game data.
 		auto dataFuture = GameData::BeginLoad(queue, player, isConsoleOnly, debugMode,
-			isConsoleOnly || checkAssets || (isTesting && !debugMode));
+			isConsoleOnly || checkAssets || isBenchmark || (isTesting && !debugMode));
 
 		// If we are not using the UI, or performing some automated task, we should load
 		// all data now.
-		if(isConsoleOnly || checkAssets || isTesting)
+		if(isConsoleOnly || checkAssets || isTesting || isBenchmark)
 			dataFuture.wait();
 
 		if(isTesting && !GameData::Tests().Has(testToRunName))
@@ -198,6 +217,13 @@ int main(int argc, char *argv[])
 			PrintTestsTable();
 			return 0;
 		}
+		if(isBenchmark)
+		{
+			bool success = RunBenchmarks(queue, benchmarkPath);
+			if(!profilePath.empty())
+				WriteProfile(profilePath);
+			return !success;
+		}
 
 		if(loadOnly || checkAssets)
 		{
@@ -263,7 +289,7 @@ int main(int argc, char *argv[])
 
 		CustomEvents::Init();
 		// This is the main loop where all the action begins.
-		GameLoop(player, queue, conversation, testToRunName, debugMode);
+		GameLoop(player, queue, conversation, testToRunName, debugMode, profilePath);
 	}
 	catch(Test::known_failure_tag)
 	{
@@ -283,6 +309,9 @@ int main(int argc, char *argv[])
 	Preferences::Save();
 	PluginManager::Save();
 
+	if(!profilePath.empty())
+		WriteProfile(profilePath);
+
 	Audio::Quit();
 	GameWindow::Quit();
 
@@ -292,7 +321,7 @@ int main(int argc, char *argv[])
 
 
 void GameLoop(PlayerInfo &player, TaskQueue &queue, const Conversation &conversation,
-		const string &testToRunName, bool debugMode)
+		const string &testToRunName, bool debugMode, const filesystem::path &profilePath)
 {
 	// gamePanels is used for the main panel where you fly your spaceship.
 	// All other game content related dialogs are placed on top of the gamePanels.
@@ -328,7 +357,7 @@ void GameLoop(PlayerInfo &player, TaskQueue &queue, const Conversation &conversa
 	const bool isHeadless = (testContext.CurrentTest() && !debugMode);
 
 	auto ProcessEvents = [&menuPanels, &gamePanels, &player, &cursorTime, &toggleTimeout, &debugMode, &isDebugPaused,
-			&isFastForward]
+			&isFastForward, &profilePath]
 	{
 		SDL_Event event;
 		while(SDL_PollEvent(&event))
@@ -347,6 +376,8 @@ void GameLoop(PlayerInfo &player, TaskQueue &queue, const Conversation &conversa
 				else
 					Audio::Resume();
 			}
+			else if(debugMode && event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F12)
+				WriteProfile(profilePath.empty() ? Files::Config() / "profile.json" : profilePath);
 			else if(event.type == SDL_KEYDOWN && menuPanels.IsEmpty()
 					&& Command(event.key.keysym.sym).Has(Command::MENU)
 					&& !gamePanels.IsEmpty() && gamePanels.Top()->IsInterruptible())
@@ -629,13 +660,18 @@ void PrintHelp()
 	cerr << "    -t, --talk: read and display a conversation from STDIN." << endl;
 	cerr << "    -r, --resources <path>: load resources from given directory." << endl;
 	cerr << "    -c, --config <path>: save user's files to given directory." << endl;
-	cerr << "    -d, --debug: turn on debugging features (e.g. Caps Lock slows down instead of speeds up)." << endl;
+	cerr << "    -d, --debug: turn on debugging features (e.g. Caps Lock slows down instead of speeds up,"
+		" F12 writes the frame profile)." << endl;
 	cerr << "    -p, --parse-save: load the most recent saved game and inspect it for content errors." << endl;
 	cerr << "    --parse-assets: load all game data, images, and sounds,"
 		" and the latest save game, and inspect data for errors." << endl;
 	cerr << "    --tests: print table of available tests, then exit." << endl;
 	cerr << "    --test <name>: run given test from resources directory." << endl;
 	cerr << "    --nomute: don't mute the game while running tests." << endl;
+	cerr << "    --profile <path>: record how long each phase of each frame takes, and write the"
+		" most recent frames to the given file as a Chrome trace when quitting." << endl;
+	cerr << "    --benchmark <path>: run the benchmarks defined in the given file without a window,"
+		" and print how long the simulation steps took." << endl;
 	cerr << "    --rng-seed <seed>: every time the pseudo-random number generator is seeded,"
 		" it will be given this value." << endl;
 	cerr << "    --tq-threads <number>: sets the number of threads used for the internal queue of tasks."
@@ -712,3 +748,46 @@ void PrintTestsTable()
 			cout << it.second.Name() << '\n';
 	cout.flush();
 }
+
+
+
+// Write the frames recorded by the profiler to the given file.
+void WriteProfile(const filesystem::path &path)
+{
+	ostringstream out;
+	Profiler::WriteTrace(out);
+	Files::Write(path, out.str());
+	Logger::Log("Wrote the frame profile to \"" + path.string() + "\".", Logger::Level::INFO);
+}
+
+
+
+// Run every benchmark defined in the given file. Returns false if any of
+// them could not be run.
+bool RunBenchmarks(TaskQueue &queue, const filesystem::path &path)
+{
+	// Wait for the sprites to finish loading, so that ships have collision masks.
+	while(GameData::GetProgress() < 1.)
+	{
+		queue.ProcessSyncTasks();
+		this_thread::yield();
+	}
+	GameData::FinishLoading();
+	GameData::GetMaskManager().ScaleMasks();
+
+	bool success = true;
+	bool found = false;
+	DataFile file(path);
+	for(const DataNode &node : file)
+	{
+		if(node.Token(0) != "benchmark")
+			continue;
+		found = true;
+		Benchmark benchmark;
+		benchmark.Load(node);
+		success &= benchmark.Run(cout);
+	}
+	if(!found)
+		Logger::Log("No benchmarks found in \"" + path.string() + "\".", Logger::Level::ERROR);
+	return success && found;
+}
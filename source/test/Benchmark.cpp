@@ -0,0 +1,207 @@
+/* Benchmark.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Benchmark.h"
+
+#include "../DataNode.h"
+#include "../Engine.h"
+#include "../Fleet.h"
+#include "../GameData.h"
+#include "../Logger.h"
+#include "../PlayerInfo.h"
+#include "../Profiler.h"
+#include "../Ship.h"
+#include "../System.h"
+#include "../text/Format.h"
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+
+using namespace std;
+
+namespace {
+	// Get the given percentile of the sorted durations, in milliseconds.
+	double Percentile(const vector<double> &sorted, double percentile)
+	{
+		if(sorted.empty())
+			return 0.;
+		size_t index = min(sorted.size() - 1, static_cast<size_t>(percentile * sorted.size()));
+		return sorted[index];
+	}
+
+	// The width of each column of numbers in the report.
+	constexpr size_t COLUMN_WIDTH = 10;
+
+	// Pad the given text with spaces on the left, so that it fills a column.
+	string Column(const string &text)
+	{
+		return string(COLUMN_WIDTH - min(COLUMN_WIDTH - 1, text.size()), ' ') + text;
+	}
+
+	// Write one line of the report, with the percentiles of the given durations.
+	void PrintPhase(ostream &out, const string &phase, size_t nameWidth, vector<double> &durations)
+	{
+		sort(durations.begin(), durations.end());
+		out << phase << string(nameWidth - phase.size(), ' ');
+		for(double percentile : {.5, .9, .99})
+			out << Column(Format::Number(Percentile(durations, percentile), 3, false));
+		out << Column(Format::Number(durations.empty() ? 0. : durations.back(), 3, false)) << endl;
+	}
+
+	// Get the time since the given moment, in milliseconds.
+	double Elapsed(chrono::steady_clock::time_point start)
+	{
+		return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	}
+}
+
+
+
+// Load a benchmark definition from a "benchmark" node.
+void Benchmark::Load(const DataNode &node)
+{
+	if(node.Size() < 2)
+	{
+		node.PrintTrace("Unnamed benchmark:");
+		return;
+	}
+	name = node.Token(1);
+
+	for(const DataNode &child : node)
+	{
+		const string &key = child.Token(0);
+		bool hasValue = child.Size() >= 2;
+		if(key == "system" && hasValue)
+			systemName = child.Token(1);
+		else if(key == "fleet" && hasValue)
+			fleets.emplace_back(child.Token(1), child.Size() >= 3 ? max(1, static_cast<int>(child.Value(2))) : 1);
+		else if(key == "warmup" && hasValue)
+			warmup = max(0, static_cast<int>(child.Value(1)));
+		else if(key == "steps" && hasValue)
+			steps = max(1, static_cast<int>(child.Value(1)));
+		else
+			child.PrintTrace("Skipping unrecognized attribute:");
+	}
+}
+
+
+
+// Run the benchmark and write a report of how long the steps took to the
+// given stream. Returns false if the scenario could not be set up.
+bool Benchmark::Run(ostream &out) const
+{
+	const System *system = GameData::Systems().Find(systemName);
+	if(!system || !system->IsValid())
+	{
+		Logger::Log("Benchmark \"" + name + "\": system \"" + systemName + "\" not found.", Logger::Level::ERROR);
+		return false;
+	}
+
+	// The player has no ships, so the engine only simulates the placed fleets
+	// and whatever fleets the system spawns by itself.
+	PlayerInfo player;
+	player.SetSystem(*system);
+	Engine engine(player);
+
+	list<shared_ptr<Ship>> ships;
+	for(const auto &[fleetName, count] : fleets)
+	{
+		const Fleet *fleet = GameData::Fleets().Find(fleetName);
+		if(!fleet || !fleet->IsValid())
+		{
+			Logger::Log("Benchmark \"" + name + "\": fleet \"" + fleetName + "\" not found.", Logger::Level::ERROR);
+			return false;
+		}
+		for(int i = 0; i < count; ++i)
+			fleet->Place(*system, ships);
+	}
+	size_t shipCount = ships.size();
+	engine.Place(ships);
+
+	// Each step is split into the work the engine does while the calculation
+	// thread is paused, and the calculation itself. Within those, the profiler
+	// records how long each phase took.
+	vector<double> stepTimes;
+	vector<double> calculateTimes;
+	vector<double> totalTimes;
+	stepTimes.reserve(steps);
+	calculateTimes.reserve(steps);
+	totalTimes.reserve(steps);
+	map<string, vector<double>> phaseTimes;
+	const bool wasProfiling = Profiler::IsEnabled();
+	Profiler::SetEnabled(true);
+
+	auto start = chrono::steady_clock::now();
+	for(int i = -warmup; i < steps; ++i)
+	{
+		if(!i)
+		{
+			// Leave out the phases recorded before the timed steps.
+			Profiler::TakeTotals();
+			start = chrono::steady_clock::now();
+		}
+
+		auto stepStart = chrono::steady_clock::now();
+		engine.Step(false);
+		double stepTime = Elapsed(stepStart);
+
+		auto calculateStart = chrono::steady_clock::now();
+		engine.Go();
+		engine.Wait();
+		double calculateTime = Elapsed(calculateStart);
+
+		if(i >= 0)
+		{
+			stepTimes.push_back(stepTime);
+			calculateTimes.push_back(calculateTime);
+			totalTimes.push_back(stepTime + calculateTime);
+			// A phase that did not happen in some steps took no time in them.
+			for(const auto &[phase, time] : Profiler::TakeTotals())
+			{
+				vector<double> &times = phaseTimes[phase];
+				times.resize(i, 0.);
+				times.push_back(time);
+			}
+		}
+	}
+	double seconds = Elapsed(start) / 1000.;
+	Profiler::SetEnabled(wasProfiling);
+
+	out << "Benchmark \"" << name << "\": " << steps << " steps with " << shipCount << " placed ships in "
+		<< Format::Number(seconds, 3, false) << " s ("
+		<< Format::Number(seconds > 0. ? steps / seconds : 0., 1, false) << " steps/s)" << endl;
+
+	size_t nameWidth = string("calculate").size();
+	for(const auto &it : phaseTimes)
+		nameWidth = max(nameWidth, it.first.size());
+	nameWidth += 2;
+	const string title = "phase (ms)";
+	out << title << string(nameWidth - min(nameWidth, title.size()), ' ');
+	for(const char *column : {"p50", "p90", "p99", "max"})
+		out << Column(column);
+	out << endl;
+	PrintPhase(out, "step", nameWidth, stepTimes);
+	PrintPhase(out, "calculate", nameWidth, calculateTimes);
+	PrintPhase(out, "total", nameWidth, totalTimes);
+	for(auto &[phase, times] : phaseTimes)
+	{
+		times.resize(steps, 0.);
+		PrintPhase(out, phase, nameWidth, times);
+	}
+	return true;
+}
@@ -0,0 +1,50 @@
+/* Benchmark.h
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+class DataNode;
+
+
+
+// Class representing a benchmark scenario: a set of fleets that are placed in
+// a system and then simulated for a number of steps, without drawing anything.
+// The time each step takes is recorded, so that the performance of the engine
+// can be tracked without needing a window or a saved game.
+class Benchmark {
+public:
+	// Load a benchmark definition from a "benchmark" node.
+	void Load(const DataNode &node);
+
+	// Run the benchmark and write a report of how long the steps took to the
+	// given stream. Returns false if the scenario could not be set up.
+	bool Run(std::ostream &out) const;
+
+
+private:
+	std::string name;
+	std::string systemName;
+	// The names of the fleets to place, and how many of each to place.
+	std::vector<std::pair<std::string, int>> fleets;
+	// Steps run before timing starts, to let the fleets engage each other.
+	int warmup = 60;
+	// Steps that are timed.
+	int steps = 3600;
+};
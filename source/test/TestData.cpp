@@ -88,6 +88,24 @@ bool TestData::Inject(const ConditionsStore *playerConditions,
 
 
 
+// Remove the test-data from the game again. Savegames are left where they
+// were written, since the game may have loaded them already.
+bool TestData::Remove() const
+{
+	if(dataSetName.empty() || sourceDataFile.empty())
+		return false;
+
+	switch(dataSetType)
+	{
+		case Type::MISSION:
+			return RemoveMission();
+		default:
+			return false;
+	}
+}
+
+
+
 const DataNode *TestData::GetContentsNode(const DataFile &sourceData) const
 {
 	for(const DataNode &rootNode : sourceData)
@@ -134,9 +152,32 @@ bool TestData::InjectMission(const ConditionsStore *playerConditions,
 		return false;
 
 	const DataNode &dataNode = *nodePtr;
+	UniverseObjects &objects = GameData::Objects();
 	for(const DataNode &node : dataNode)
 		if(node.Token(0) == "mission" && node.Size() > 1)
-			GameData::Objects().missions.Get(node.Token(1))->Load(node, playerConditions, visitedSystems, visitedPlanets);
+			objects.missions.Get(node.Token(1))->Load(node, playerConditions, visitedSystems, visitedPlanets);
+	// The missions may be offered in different places now.
+	objects.missionOffers.Build(objects.missions);
+
+	return true;
+}
+
+
+
+bool TestData::RemoveMission() const
+{
+	const DataFile sourceData(sourceDataFile);
+	// Get the contents node in the test data.
+	const auto &nodePtr = GetContentsNode(sourceData);
+	if(!nodePtr)
+		return false;
+
+	UniverseObjects &objects = GameData::Objects();
+	for(const DataNode &node : *nodePtr)
+		if(node.Token(0) == "mission" && node.Size() > 1)
+			objects.missions.Erase(node.Token(1));
+	// The missions are no longer offered anywhere.
+	objects.missionOffers.Build(objects.missions);
 
 	return true;
 }
@@ -36,6 +36,8 @@ public:
 	// environment.
 	bool Inject(const ConditionsStore *playerConditions, const std::set<const System *> *visitedSystems,
 		const std::set<const Planet *> *visitedPlanets) const;
+	// Remove the test-data from the game again, as far as that is possible.
+	bool Remove() const;
 
 	// Types of datafiles that can be stored.
 	enum class Type {UNSPECIFIED, SAVEGAME, MISSION};
@@ -51,6 +53,8 @@ private:
 	// Loads a mission stored in testdata into a Mission through GameData.
 	bool InjectMission(const ConditionsStore *playerConditions, const std::set<const System *> *visitedSystems,
 		const std::set<const Planet *> *visitedPlanets) const;
+	// Removes the missions stored in testdata from GameData.
+	bool RemoveMission() const;
 
 
 private:
@@ -254,6 +254,20 @@ SCENARIO( "Determining if condition requirements are met", "[ConditionSet][Usage
 			{"0 or 0 or 0", 0},
 			{"0 or 0 or -7", -7},
 
+			// Tests for and and or with variables, whose values are only known when evaluating.
+			{"someData and missingData and 5", 0},
+			{"someData and moreData - 50", 100},
+			{"missingData or moreData - 50 or someData", 50},
+			{"missingData or missingData", 0},
+			{"or\n\t\tmissingData\n\t\tsomeData", 100},
+
+			// An expression that needs many intermediate values while being evaluated.
+			{"someData + ( someData + ( someData + ( someData + ( someData + ( "
+				"someData + ( someData + ( someData + ( someData + ( someData + ( "
+				"someData + ( someData + ( someData + ( someData + ( someData + ( "
+				"someData + ( someData + ( someData + ( someData + ( someData + ( "
+				"someData ) ) ) ) ) ) ) ) ) ) ) ) ) ) ) ) ) ) ) )", 2100},
+
 			// Some tests with not.
 			{"not someData", 0},
 			{"not missingData", 1},
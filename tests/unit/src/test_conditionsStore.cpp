@@ -20,6 +20,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 // ... and any system includes needed for the test file.
 #include <map>
+#include <set>
 #include <string>
 
 
@@ -596,6 +597,133 @@ SCENARIO( "Providing multiple derived conditions", "[ConditionStore][DerivedMult
 	}
 }
 
+SCENARIO( "Reading conditions through handles", "[ConditionStore][Handles]" )
+{
+	GIVEN( "A store with a primary condition and a prefixed provider" )
+	{
+		auto mockProvPrefix = MockConditionsProvider();
+		auto store = ConditionsStore{ { "myFirstVar", 10 } };
+		mockProvPrefix.SetRWPrefixProvider(store, "prefixA: ");
+		mockProvPrefix.values["prefixA: test"] = 25;
+		const ConditionsStore::Handle *first = store.GetHandle("myFirstVar");
+		const ConditionsStore::Handle *prefixed = store.GetHandle("prefixA: test");
+		const ConditionsStore::Handle *missing = store.GetHandle("mySecondVar");
+		THEN( "handles for the same name are the same" )
+		{
+			REQUIRE( store.GetHandle("myFirstVar") == first );
+			REQUIRE( first->Name() == "myFirstVar" );
+		}
+		THEN( "reading through handles gives the same values as reading by name" )
+		{
+			REQUIRE( store.Get(*first) == 10 );
+			REQUIRE( store.Get(*prefixed) == 25 );
+			REQUIRE( store.Get(*missing) == 0 );
+			REQUIRE( store.PrimariesSize() == 1 );
+		}
+		WHEN( "the conditions change after they were read" )
+		{
+			REQUIRE( store.Get(*first) == 10 );
+			REQUIRE( store.Get(*missing) == 0 );
+			store.Set("myFirstVar", 20);
+			store.Set("mySecondVar", 30);
+			mockProvPrefix.values["prefixA: test"] = 35;
+			THEN( "the handles read the new values" )
+			{
+				REQUIRE( store.Get(*first) == 20 );
+				REQUIRE( store.Get(*missing) == 30 );
+				REQUIRE( store.Get(*prefixed) == 35 );
+			}
+		}
+		WHEN( "a provider is registered for a name that was read before" )
+		{
+			REQUIRE( store.Get(*missing) == 0 );
+			auto mockProvNamed = MockConditionsProvider();
+			mockProvNamed.SetRONamedProvider(store, "mySecondVar");
+			mockProvNamed.values["mySecondVar"] = 40;
+			THEN( "the handle reads from the provider" )
+			{
+				REQUIRE( store.Get(*missing) == 40 );
+			}
+		}
+		WHEN( "the content of the store is replaced" )
+		{
+			REQUIRE( store.Get(*first) == 10 );
+			store = ConditionsStore{ { "myFirstVar", 50 } };
+			THEN( "the handles remain valid and read the new content" )
+			{
+				REQUIRE( store.GetHandle("myFirstVar") == first );
+				REQUIRE( store.Get(*first) == 50 );
+				REQUIRE( store.Get(*prefixed) == 0 );
+			}
+		}
+	}
+}
+
+
+SCENARIO( "Recording changes to conditions", "[ConditionStore][Changes]" )
+{
+	GIVEN( "A store with primary conditions and a prefixed provider" )
+	{
+		auto mockProvPrefix = MockConditionsProvider();
+		auto store = ConditionsStore{ { "myFirstVar", 10 }, { "mySecondVar", 20 } };
+		mockProvPrefix.SetRWPrefixProvider(store, "prefixA: ");
+		const uint64_t revision = store.ProviderRevision();
+		THEN( "the initial conditions are recorded as changed once" )
+		{
+			REQUIRE( store.TakeChanges() == std::set<std::string>{ "myFirstVar", "mySecondVar" } );
+			REQUIRE( store.TakeChanges().empty() );
+		}
+		THEN( "only the conditions from providers are derived" )
+		{
+			REQUIRE_FALSE( store.IsDerived("myFirstVar") );
+			REQUIRE_FALSE( store.IsDerived("myThirdVar") );
+			REQUIRE( store.IsDerived("prefixA: test") );
+		}
+		WHEN( "conditions are set, added to or created" )
+		{
+			store.TakeChanges();
+			store.Set("myFirstVar", 15);
+			store.Add("myThirdVar", 5);
+			++store["myThirdVar"];
+			THEN( "only those conditions are recorded as changed" )
+			{
+				REQUIRE( store.TakeChanges() == std::set<std::string>{ "myFirstVar", "myThirdVar" } );
+			}
+		}
+		WHEN( "conditions are only read" )
+		{
+			store.TakeChanges();
+			REQUIRE( store.Get("myFirstVar") == 10 );
+			REQUIRE( store["myFourthVar"] == 0 );
+			THEN( "no changes are recorded" )
+			{
+				REQUIRE( store.TakeChanges().empty() );
+			}
+		}
+		WHEN( "another provider is registered" )
+		{
+			auto mockProvNamed = MockConditionsProvider();
+			mockProvNamed.SetRONamedProvider(store, "mySecondVar");
+			THEN( "the provider revision changes and the condition is derived" )
+			{
+				REQUIRE( store.ProviderRevision() != revision );
+				REQUIRE( store.IsDerived("mySecondVar") );
+			}
+		}
+		WHEN( "the content of the store is replaced" )
+		{
+			store.TakeChanges();
+			store = ConditionsStore{ { "myFirstVar", 50 } };
+			THEN( "every condition in it is recorded as changed" )
+			{
+				REQUIRE( store.ProviderRevision() != revision );
+				REQUIRE( store.TakeChanges() == std::set<std::string>{ "myFirstVar" } );
+				store.Set("myFirstVar", 60);
+				REQUIRE( store.TakeChanges() == std::set<std::string>{ "myFirstVar" } );
+			}
+		}
+	}
+}
 
 // #endregion unit tests
 
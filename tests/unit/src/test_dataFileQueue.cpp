@@ -0,0 +1,123 @@
+/* test_dataFileQueue.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/DataFileQueue.h"
+
+// ... and any system includes needed for the test file.
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+// Get the names of some files, of which the one with the given index cannot be parsed.
+std::vector<std::filesystem::path> Files(int count, int broken = -1)
+{
+	std::vector<std::filesystem::path> files;
+	for(int i = 0; i < count; ++i)
+		files.emplace_back("data/" + std::string(i == broken ? "broken" : "file") + std::to_string(i) + ".txt");
+	return files;
+}
+
+// Keeps track of how often files were parsed, and how many are being parsed right now.
+struct Counts {
+	std::atomic<int> started = 0;
+	std::atomic<int> finished = 0;
+};
+
+// "Parse" a file, by giving it a node that holds its own name. This takes a
+// little while, so that some files are still being parsed when the queue is
+// destroyed. Files whose names start with "broken" cannot be parsed.
+void Parse(const std::filesystem::path &path, DataFile &file, Counts &counts)
+{
+	++counts.started;
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	if(path.stem().string().starts_with("broken"))
+	{
+		++counts.finished;
+		throw std::runtime_error("Unable to parse " + path.string());
+	}
+	std::istringstream in("file \"" + path.stem().string() + "\"\n");
+	file.Load(in);
+	++counts.finished;
+}
+
+// Get the name that was given to the first node of the given file.
+std::string Name(const DataFile &file)
+{
+	for(const DataNode &node : file)
+		if(node.Size() >= 2)
+			return node.Token(1);
+	return {};
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Parsing data files ahead of loading them", "[DataFileQueue]" ) {
+	auto counts = std::make_shared<Counts>();
+	auto parse = [counts](const std::filesystem::path &path, DataFile &file) { Parse(path, file, *counts); };
+
+	GIVEN( "files that can all be parsed" ) {
+		auto queue = std::make_unique<DataFileQueue>(Files(40), parse, 4);
+		REQUIRE( queue->Size() == 40 );
+
+		THEN( "each file can be taken in order, with its own contents" ) {
+			for(size_t i = 0; i < queue->Size(); ++i)
+			{
+				CHECK( queue->Path(i) == Files(40)[i] );
+				CHECK( Name(queue->Take(i)) == "file" + std::to_string(i) );
+			}
+			queue.reset();
+			CHECK( counts->started == 40 );
+			CHECK( counts->finished == 40 );
+		}
+	}
+	GIVEN( "a file that cannot be parsed" ) {
+		auto queue = std::make_unique<DataFileQueue>(Files(40, 5), parse, 16);
+
+		THEN( "the error is thrown when that file is taken" ) {
+			for(size_t i = 0; i < 5; ++i)
+				CHECK( Name(queue->Take(i)) == "file" + std::to_string(i) );
+			CHECK_THROWS_WITH( queue->Take(5), "Unable to parse data/broken5.txt" );
+		}
+		THEN( "the files queued after it have been parsed by the time the queue is gone" ) {
+			for(size_t i = 0; i < 5; ++i)
+				queue->Take(i);
+			CHECK_THROWS( queue->Take(5) );
+			queue.reset();
+			CHECK( counts->started == 5 + 1 + 16 );
+			CHECK( counts->finished == counts->started );
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
@@ -30,6 +30,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace { // test namespace
@@ -104,6 +105,76 @@ node2 hi
 	}
 }
 
+SCENARIO( "Loading a DataFile with non-ASCII text", "[DataFile]" ) {
+	GIVEN( "A byte order mark, multi-byte characters, and no trailing newline" ) {
+		std::istringstream stream("\xEF\xBB\xBFplanet \"M\xC3\xA9ridien\" # \xE2\x82\xAC\n\tdescription \xF0\x9F\x9A\x80`quote`");
+		const DataFile root(stream);
+
+		THEN( "the byte order mark is skipped" ) {
+			REQUIRE( std::distance(root.begin(), root.end()) == 1 );
+			CHECK( root.begin()->Token(0) == "planet" );
+		}
+		AND_THEN( "multi-byte characters are kept as part of their tokens" ) {
+			const DataNode &planet = *root.begin();
+			REQUIRE( planet.Size() == 2 );
+			CHECK( planet.Token(1) == "M\xC3\xA9ridien" );
+			REQUIRE( std::distance(planet.begin(), planet.end()) == 1 );
+			const DataNode &description = *planet.begin();
+			REQUIRE( description.Size() == 2 );
+			CHECK( description.Token(1) == "\xF0\x9F\x9A\x80`quote`" );
+		}
+	}
+}
+
+SCENARIO( "Saving a DataFile in binary form", "[DataFile]" ) {
+	GIVEN( "A DataFile with nested nodes" ) {
+		std::istringstream stream(R"(
+node1 "with spaces"
+	child 1
+		grand child
+	child 2
+
+node2 `"quoted"`
+)");
+		const DataFile original(stream);
+		const std::string binary = original.SaveBinary("key");
+
+		WHEN( "it is loaded again with the same key" ) {
+			DataFile loaded;
+			REQUIRE( loaded.LoadBinary(binary, "key") );
+			THEN( "it has the same nodes and tokens" ) {
+				REQUIRE( std::distance(loaded.begin(), loaded.end()) == 2 );
+				const DataNode &node1 = *loaded.begin();
+				REQUIRE( node1.Size() == 2 );
+				CHECK( node1.Token(1) == "with spaces" );
+				REQUIRE( std::distance(node1.begin(), node1.end()) == 2 );
+				const DataNode &child = *node1.begin();
+				CHECK( child.Value(1) == 1. );
+				REQUIRE( child.HasChildren() );
+				CHECK( child.begin()->Token(1) == "child" );
+				CHECK( std::next(node1.begin())->Value(1) == 2. );
+				const DataNode &node2 = *std::next(loaded.begin());
+				CHECK_FALSE( node2.HasChildren() );
+				CHECK( node2.Token(1) == "\"quoted\"" );
+			}
+		}
+		WHEN( "it is loaded with a different key" ) {
+			DataFile loaded;
+			THEN( "nothing is loaded" ) {
+				CHECK_FALSE( loaded.LoadBinary(binary, "other key") );
+				CHECK( loaded.begin() == loaded.end() );
+			}
+		}
+		WHEN( "the data is incomplete" ) {
+			DataFile loaded;
+			THEN( "nothing is loaded" ) {
+				CHECK_FALSE( loaded.LoadBinary(std::string_view(binary).substr(0, binary.size() - 1), "key") );
+				CHECK( loaded.begin() == loaded.end() );
+			}
+		}
+	}
+}
+
 SCENARIO( "Loading a DataFile with missing quotes", "[DataFile]" ) {
 	OutputSink sink(std::cerr);
 
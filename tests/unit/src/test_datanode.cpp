@@ -42,8 +42,7 @@ TEST_CASE( "DataNode Basics", "[DataNode]" ) {
 	using T = DataNode;
 	SECTION( "Class Traits" ) {
 		CHECK_FALSE( std::is_trivial_v<T> );
-		// The class layout apparently satisfies StandardLayoutType when building/testing for Steam, but false otherwise.
-		// This may change in the future, with the expectation of false everywhere (due to the list<DataNode> field).
+		// Whether the class layout satisfies StandardLayoutType depends on the standard library.
 		// CHECK_FALSE( std::is_standard_layout_v<T> );
 		CHECK( std::is_nothrow_destructible_v<T> );
 		CHECK_FALSE( std::is_trivially_destructible_v<T> );
@@ -51,8 +50,8 @@ TEST_CASE( "DataNode Basics", "[DataNode]" ) {
 	SECTION( "Construction Traits" ) {
 		CHECK( std::is_default_constructible_v<T> );
 		CHECK_FALSE( std::is_trivially_default_constructible_v<T> );
-		// We explicitly allocate some memory when default-constructing DataNodes.
-		CHECK_FALSE( std::is_nothrow_default_constructible_v<T> );
+		// Default-constructed DataNodes do not allocate any memory until they are given tokens or children.
+		CHECK( std::is_nothrow_default_constructible_v<T> );
 		CHECK( std::is_copy_constructible_v<T> );
 		// We have work to do when copy-constructing, including allocations.
 		CHECK_FALSE( std::is_trivially_copy_constructible_v<T> );
@@ -64,7 +63,7 @@ TEST_CASE( "DataNode Basics", "[DataNode]" ) {
 	}
 	SECTION( "Copy Traits" ) {
 		CHECK( std::is_copy_assignable_v<T> );
-		// The class data can be spread out due to vector + list contents.
+		// The class data is spread out over the storage of the node's tree.
 		CHECK_FALSE( std::is_trivially_copyable_v<T> );
 		// We have work to do when copying.
 		CHECK_FALSE( std::is_trivially_copy_assignable_v<T> );
@@ -86,9 +85,6 @@ SCENARIO( "Creating a DataNode", "[DataNode]") {
 			CHECK_FALSE( root.HasChildren() );
 			CHECK( root.Tokens().empty() );
 		}
-		THEN( "it preallocates capacity for tokens" ) {
-			CHECK( root.Tokens().capacity() == 4 );
-		}
 	}
 	GIVEN( "When created without a parent" ) {
 		THEN( "it prints its token trace at the correct level" ) {
@@ -0,0 +1,173 @@
+/* test_imageBuffer.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/image/ImageBuffer.h"
+
+// ... and any system includes needed for the test file.
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+// Fill every frame of the buffer with the same pseudo-random pixels each time.
+void Fill(ImageBuffer &buffer, int width, int height)
+{
+	buffer.Allocate(width, height);
+	uint32_t state = 12345;
+	uint32_t *it = buffer.Pixels();
+	for(uint32_t *end = it + width * height * buffer.Frames(); it != end; ++it)
+	{
+		state = state * 1664525 + 1013904223;
+		*it = state;
+	}
+	// Include fully transparent and fully opaque pixels, too.
+	if(width * height >= 2)
+	{
+		buffer.Pixels()[0] &= 0x00FFFFFF;
+		buffer.Pixels()[1] |= 0xFF000000;
+	}
+}
+
+// The per-pixel conversion that the vectorized kernels must match exactly.
+std::vector<uint32_t> ReferencePremultiply(const ImageBuffer &buffer, int frame, BlendingMode blend)
+{
+	const uint32_t *begin = buffer.Begin(0, frame);
+	std::vector<uint32_t> result(begin, begin + buffer.Width() * buffer.Height());
+	for(uint32_t &pixel : result)
+	{
+		uint64_t value = pixel;
+		uint64_t alpha = (value & 0xFF000000) >> 24;
+
+		uint64_t red = (((value & 0xFF0000) * alpha) / 255) & 0xFF0000;
+		uint64_t green = (((value & 0xFF00) * alpha) / 255) & 0xFF00;
+		uint64_t blue = (((value & 0xFF) * alpha) / 255) & 0xFF;
+
+		value = red | green | blue;
+		if(blend == BlendingMode::HALF_ADDITIVE)
+			alpha >>= 2;
+		if(blend != BlendingMode::ADDITIVE)
+			value |= (alpha << 24);
+
+		pixel = static_cast<uint32_t>(value);
+	}
+	return result;
+}
+
+// The averaging that the vectorized kernels must match exactly.
+std::vector<uint32_t> ReferenceShrink(const ImageBuffer &buffer)
+{
+	const int width = buffer.Width() / 2;
+	const int rows = buffer.Height() / 2 * buffer.Frames();
+	std::vector<uint32_t> result(width * rows);
+	const unsigned char *begin = reinterpret_cast<const unsigned char *>(buffer.Pixels());
+	unsigned char *out = reinterpret_cast<unsigned char *>(result.data());
+	for(int y = 0; y < rows; ++y)
+	{
+		const unsigned char *aIt = begin + (4 * buffer.Width()) * (2 * y);
+		const unsigned char *aEnd = aIt + 4 * 2 * width;
+		const unsigned char *bIt = begin + (4 * buffer.Width()) * (2 * y + 1);
+		for( ; aIt != aEnd; aIt += 4, bIt += 4)
+			for(int channel = 0; channel < 4; ++channel, ++aIt, ++bIt, ++out)
+				*out = (static_cast<unsigned>(aIt[0]) + static_cast<unsigned>(bIt[0])
+					+ static_cast<unsigned>(aIt[4]) + static_cast<unsigned>(bIt[4]) + 2) / 4;
+	}
+	return result;
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Converting an image to premultiplied alpha", "[ImageBuffer][Premultiply]" ) {
+	auto blend = GENERATE(BlendingMode::ALPHA, BlendingMode::HALF_ADDITIVE, BlendingMode::ADDITIVE);
+	// Widths that are not a multiple of the vector sizes exercise the scalar tail.
+	auto width = GENERATE(1, 3, 4, 7, 8, 9, 16, 33, 64);
+	GIVEN( "an image of width " + std::to_string(width) ) {
+		ImageBuffer buffer(2);
+		Fill(buffer, width, 5);
+		const std::vector<uint32_t> expected = ReferencePremultiply(buffer, 1, blend);
+		const std::vector<uint32_t> untouched(buffer.Begin(0, 0), buffer.Begin(0, 1));
+
+		WHEN( "the second frame is converted" ) {
+			buffer.Premultiply(1, blend);
+			THEN( "every pixel of it matches the per-pixel conversion" ) {
+				CHECK( std::equal(expected.begin(), expected.end(), buffer.Begin(0, 1)) );
+			}
+			THEN( "the first frame is not changed" ) {
+				CHECK( std::equal(untouched.begin(), untouched.end(), buffer.Begin(0, 0)) );
+			}
+		}
+	}
+}
+
+SCENARIO( "Shrinking an image to half size", "[ImageBuffer][ShrinkToHalfSize]" ) {
+	auto width = GENERATE(2, 3, 6, 8, 15, 16, 17, 34, 66);
+	auto height = GENERATE(2, 3, 4);
+	GIVEN( "an image of size " + std::to_string(width) + "x" + std::to_string(height) ) {
+		ImageBuffer buffer(3);
+		Fill(buffer, width, height);
+		const std::vector<uint32_t> expected = ReferenceShrink(buffer);
+
+		WHEN( "it is shrunk" ) {
+			REQUIRE( buffer.ShrinkToHalfSize() );
+			THEN( "it has half the size" ) {
+				CHECK( buffer.Width() == width / 2 );
+				CHECK( buffer.Height() == height / 2 );
+				CHECK( buffer.Frames() == 3 );
+			}
+			THEN( "every pixel is the rounded average of the four it replaces" ) {
+				CHECK( std::equal(expected.begin(), expected.end(), buffer.Pixels()) );
+			}
+		}
+	}
+	GIVEN( "an image that is too small" ) {
+		ImageBuffer buffer;
+		Fill(buffer, 1, 4);
+		THEN( "it is not shrunk" ) {
+			CHECK_FALSE( buffer.ShrinkToHalfSize() );
+			CHECK( buffer.Width() == 1 );
+		}
+	}
+}
+// #endregion unit tests
+
+// #region benchmarks
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+TEST_CASE( "Benchmark ImageBuffer pixel conversions", "[!benchmark][ImageBuffer]" ) {
+	BENCHMARK_ADVANCED( "ImageBuffer::Premultiply() on 1024x1024" )(Catch::Benchmark::Chronometer meter) {
+		ImageBuffer buffer;
+		Fill(buffer, 1024, 1024);
+		meter.measure([&buffer] { buffer.Premultiply(0, BlendingMode::ALPHA); });
+	};
+	BENCHMARK_ADVANCED( "ImageBuffer::ShrinkToHalfSize() on 1024x1024" )(Catch::Benchmark::Chronometer meter) {
+		std::vector<ImageBuffer> buffers(meter.runs());
+		for(ImageBuffer &buffer : buffers)
+			Fill(buffer, 1024, 1024);
+		meter.measure([&buffers](int i) { return buffers[i].ShrinkToHalfSize(); });
+	};
+}
+#endif
+// #endregion benchmarks
+
+
+
+} // test namespace
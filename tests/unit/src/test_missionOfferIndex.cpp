@@ -0,0 +1,282 @@
+/* test_missionOfferIndex.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/MissionOfferIndex.h"
+
+// Include a helper for creating well-formed DataNodes.
+#include "datanode-factory.h"
+
+// ... and any system includes needed for the test file.
+#include "../../../source/ConditionsStore.h"
+#include "../../../source/GameData.h"
+#include "../../../source/Government.h"
+#include "../../../source/Planet.h"
+#include "../../../source/Ship.h"
+#include "../../../source/System.h"
+#include "../../../source/Wormhole.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+ConditionsStore store;
+std::set<const System *> visitedSystems;
+std::set<const Planet *> visitedPlanets;
+
+// Load the missions defined in the given text. They are kept in the order of
+// their names, as in GameData::Missions().
+void LoadMissions(Set<Mission> &missions, const std::string &text)
+{
+	for(const DataNode &node : AsDataNodes(text))
+		missions.Get(node.Token(1))->Load(node, &store, &visitedSystems, &visitedPlanets);
+}
+
+// Get the names of the given missions, in the order they were given.
+std::vector<std::string> Names(const std::vector<const Mission *> &missions)
+{
+	std::vector<std::string> names;
+	for(const Mission *mission : missions)
+		names.push_back(mission->TrueName());
+	return names;
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Finding the missions that might be offered on a planet", "[MissionOfferIndex]" ) {
+	Set<Wormhole> wormholes;
+	const System *sol = GameData::Systems().Get("Index Sol");
+	const System *vega = GameData::Systems().Get("Index Vega");
+	const Planet *earth = GameData::Planets().Get("Index Earth");
+
+	GIVEN( "missions with a source planet" ) {
+		Set<Mission> missions;
+		LoadMissions(missions,
+			"mission \"A anywhere\"\n"
+			"mission \"B from Earth\"\n"
+			"\tsource \"Index Earth\"\n"
+			"mission \"C anywhere\"\n"
+			"\tjob\n"
+			"mission \"D from Mars\"\n"
+			"\tsource \"Index Mars\"\n");
+		MissionOfferIndex index;
+		index.Build(missions);
+
+		THEN( "only the missions from that planet and those without requirements are candidates" ) {
+			CHECK( Names(index.Candidates(earth)) == std::vector<std::string>{"A anywhere", "B from Earth",
+				"C anywhere"} );
+			CHECK( Names(index.Candidates(GameData::Planets().Get("Index Mars"))) == std::vector<std::string>{
+				"A anywhere", "C anywhere", "D from Mars"} );
+		}
+		THEN( "there are no candidates without a planet" ) {
+			CHECK( index.Candidates(nullptr).empty() );
+		}
+	}
+	GIVEN( "missions whose source filter names planets, systems or governments" ) {
+		Set<Mission> missions;
+		LoadMissions(missions,
+			"mission \"A planet\"\n"
+			"\tsource\n"
+			"\t\tplanet \"Index Earth\" \"Index Venus\"\n"
+			"mission \"B anywhere\"\n"
+			"mission \"C system\"\n"
+			"\tsource\n"
+			"\t\tsystem \"Index Sol\"\n"
+			"mission \"D government\"\n"
+			"\tsource\n"
+			"\t\tgovernment \"Index Republic\"\n"
+			"mission \"E other system\"\n"
+			"\tsource\n"
+			"\t\tsystem \"Index Vega\"\n"
+			"\t\tgovernment \"Index Republic\"\n");
+		MissionOfferIndex index;
+		index.Build(missions);
+
+		Planet moon;
+		moon.Load(AsDataNode("planet \"Index Moon\"\n\tgovernment \"Index Republic\""), wormholes, nullptr);
+		moon.SetSystem(sol);
+		Planet outpost;
+		outpost.Load(AsDataNode("planet \"Index Outpost\"\n\tgovernment \"Index Syndicate\""), wormholes, nullptr);
+		outpost.SetSystem(vega);
+
+		THEN( "a mission is a candidate wherever it matches the first kind of thing its filter names" ) {
+			CHECK( Names(index.Candidates(earth)) == std::vector<std::string>{"A planet", "B anywhere"} );
+			CHECK( Names(index.Candidates(GameData::Planets().Get("Index Venus"))) == std::vector<std::string>{
+				"A planet", "B anywhere"} );
+			CHECK( Names(index.Candidates(&moon)) == std::vector<std::string>{"B anywhere", "C system",
+				"D government"} );
+			CHECK( Names(index.Candidates(&outpost)) == std::vector<std::string>{"B anywhere", "E other system"} );
+		}
+	}
+	GIVEN( "missions whose source filter only requires attributes" ) {
+		Set<Mission> missions;
+		LoadMissions(missions,
+			"mission \"A urban\"\n"
+			"\tsource\n"
+			"\t\tattributes urban\n"
+			"mission \"B anywhere\"\n"
+			"mission \"C urban or rich\"\n"
+			"\tsource\n"
+			"\t\tattributes urban rich\n"
+			"mission \"D farming\"\n"
+			"\tsource\n"
+			"\t\tattributes farming\n");
+		MissionOfferIndex index;
+		index.Build(missions);
+
+		Planet city;
+		city.Load(AsDataNode("planet \"Index City\"\n\tattributes urban rich"), wormholes, nullptr);
+		city.SetSystem(sol);
+		Planet farm;
+		farm.Load(AsDataNode("planet \"Index Farm\"\n\tattributes farming"), wormholes, nullptr);
+		farm.SetSystem(sol);
+
+		THEN( "a mission is a candidate on planets with any of the attributes it names" ) {
+			CHECK( Names(index.Candidates(&city)) == std::vector<std::string>{"A urban", "B anywhere",
+				"C urban or rich"} );
+			CHECK( Names(index.Candidates(&farm)) == std::vector<std::string>{"B anywhere", "D farming"} );
+		}
+	}
+	GIVEN( "missions that are offered in flight" ) {
+		Set<Mission> missions;
+		LoadMissions(missions,
+			"mission \"A landed\"\n"
+			"mission \"B entering\"\n"
+			"\tentering\n"
+			"mission \"C boarding\"\n"
+			"\tboarding\n"
+			"mission \"D landed\"\n"
+			"\tlanding\n");
+		MissionOfferIndex index;
+		index.Build(missions);
+
+		THEN( "they are not candidates while landed" ) {
+			CHECK( Names(index.Candidates(earth)) == std::vector<std::string>{"A landed", "D landed"} );
+		}
+	}
+}
+
+SCENARIO( "Finding the missions that might be offered in a system", "[MissionOfferIndex]" ) {
+	Set<Wormhole> wormholes;
+	Set<Planet> planets;
+	GIVEN( "missions offered on entering a system" ) {
+		Set<Mission> missions;
+		LoadMissions(missions,
+			"mission \"A system\"\n"
+			"\tentering\n"
+			"\tsource\n"
+			"\t\tsystem \"Index Frontier\"\n"
+			"mission \"B urban\"\n"
+			"\tentering\n"
+			"\tsource\n"
+			"\t\tattributes urban\n"
+			"mission \"C anywhere\"\n"
+			"\tentering\n"
+			"mission \"D remote\"\n"
+			"\tentering\n"
+			"\tsource\n"
+			"\t\tattributes remote\n"
+			"mission \"E transition\"\n"
+			"\ttransition\n"
+			"mission \"F landed\"\n");
+		MissionOfferIndex index;
+		index.Build(missions);
+
+		planets.Get("Index Metropolis")->Load(AsDataNode("planet \"Index Metropolis\"\n\tattributes urban"),
+			wormholes, nullptr);
+		System core;
+		core.Load(AsDataNode("system \"Index Core\"\n\tpos 0 0\n\tobject \"Index Metropolis\""),
+			planets, nullptr);
+		System remote;
+		remote.Load(AsDataNode("system \"Index Remote\"\n\tpos 0 0\n\tattributes remote"), planets, nullptr);
+		const System *frontier = GameData::Systems().Get("Index Frontier");
+
+		THEN( "a mission is a candidate if the system or one of its planets has an attribute it names" ) {
+			CHECK( Names(index.Candidates(Mission::ENTERING, &core)) == std::vector<std::string>{"B urban",
+				"C anywhere"} );
+			CHECK( Names(index.Candidates(Mission::ENTERING, &remote)) == std::vector<std::string>{"C anywhere",
+				"D remote"} );
+		}
+		THEN( "a mission is a candidate in the systems its filter names" ) {
+			CHECK( Names(index.Candidates(Mission::ENTERING, frontier)) == std::vector<std::string>{"A system",
+				"C anywhere"} );
+		}
+		THEN( "only the missions offered at the given location are candidates" ) {
+			CHECK( Names(index.Candidates(Mission::TRANSITION, frontier)) == std::vector<std::string>{
+				"E transition"} );
+			CHECK( index.Candidates(Mission::ASSISTING, frontier).empty() );
+			CHECK( index.Candidates(Mission::ENTERING, static_cast<const System *>(nullptr)).empty() );
+		}
+	}
+}
+
+SCENARIO( "Finding the missions that might be offered by a ship", "[MissionOfferIndex]" ) {
+	GIVEN( "missions offered on boarding a ship" ) {
+		Set<Mission> missions;
+		LoadMissions(missions,
+			"mission \"A government\"\n"
+			"\tboarding\n"
+			"\tsource\n"
+			"\t\tgovernment \"Index Pirate\"\n"
+			"mission \"B attributes\"\n"
+			"\tboarding\n"
+			"\tsource\n"
+			"\t\tattributes \"index nowhere\"\n"
+			"mission \"C system\"\n"
+			"\tboarding\n"
+			"\tsource\n"
+			"\t\tsystem \"Index Badlands\"\n"
+			"mission \"D anywhere\"\n"
+			"\tboarding\n"
+			"mission \"E assisting\"\n"
+			"\tassisting\n");
+		MissionOfferIndex index;
+		index.Build(missions);
+
+		Ship pirate;
+		pirate.SetGovernment(GameData::Governments().Get("Index Pirate"));
+		pirate.SetSystem(GameData::Systems().Get("Index Badlands"));
+		Ship merchant;
+		merchant.SetGovernment(GameData::Governments().Get("Index Merchant"));
+		merchant.SetSystem(GameData::Systems().Get("Index Sol"));
+
+		THEN( "attribute filters are ignored, since ships have no attributes to match" ) {
+			CHECK( Names(index.Candidates(Mission::BOARDING, merchant)) == std::vector<std::string>{"B attributes",
+				"D anywhere"} );
+		}
+		THEN( "the ship's government and system are matched" ) {
+			CHECK( Names(index.Candidates(Mission::BOARDING, pirate)) == std::vector<std::string>{"A government",
+				"B attributes", "C system", "D anywhere"} );
+		}
+		THEN( "only the missions offered at the given location are candidates" ) {
+			CHECK( Names(index.Candidates(Mission::ASSISTING, merchant)) == std::vector<std::string>{
+				"E assisting"} );
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
@@ -0,0 +1,186 @@
+/* test_playerInfo.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/PlayerInfo.h"
+
+// Include a helper for creating well-formed DataNodes.
+#include "datanode-factory.h"
+
+// ... and any system includes needed for the test file.
+#include "../../../source/ConditionsStore.h"
+#include "../../../source/Planet.h"
+#include "../../../source/Random.h"
+#include "../../../source/Set.h"
+#include "../../../source/System.h"
+#include "../../../source/TaskQueue.h"
+#include "../../../source/UI.h"
+#include "../../../source/Wormhole.h"
+#include "../../../source/test/TestData.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+ConditionsStore store;
+std::set<const System *> visitedSystems;
+std::set<const Planet *> visitedPlanets;
+
+// Jobs whose passenger counts are picked at random when they are offered.
+std::string Jobs()
+{
+	std::string text = "test-data \"Offered Jobs\"\n"
+		"\tcategory mission\n"
+		"\tcontents\n";
+	for(int i = 10; i < 40; ++i)
+		text += "\t\tmission \"Job " + std::to_string(i) + "\"\n"
+			"\t\t\tjob\n"
+			"\t\t\tpassengers 1 1000\n";
+	return text;
+}
+
+// Adds the jobs to the game data, in the same way that the integration tests
+// add missions, and removes them again once it is destroyed.
+class InjectedJobs {
+public:
+	InjectedJobs()
+	{
+		std::ofstream(path) << Jobs();
+		testData.Load(AsDataNode(Jobs()), path);
+		injected = testData.Inject(&store, &visitedSystems, &visitedPlanets);
+	}
+	~InjectedJobs()
+	{
+		testData.Remove();
+		std::filesystem::remove(path);
+	}
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "es-test-offered-jobs.txt";
+	TestData testData;
+	bool injected = false;
+};
+
+// Keeps every worker thread busy for as long as it exists, so that any tasks
+// that are queued in the meantime are run by the thread that waits for them.
+class BusyWorkers {
+public:
+	BusyWorkers()
+	{
+		for(uint64_t i = 0; i < TaskQueue::WorkerThreadCount(); ++i)
+			queue.Run([this]
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				++busy;
+				condition.notify_all();
+				condition.wait(lock, [this] { return released; });
+			});
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [this] { return busy == TaskQueue::WorkerThreadCount(); });
+	}
+	~BusyWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			released = true;
+		}
+		condition.notify_all();
+		queue.Wait();
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable condition;
+	uint64_t busy = 0;
+	bool released = false;
+	TaskQueue queue;
+};
+
+// Land on the given planet, with the random numbers drawn from the given seed,
+// and get the names and passenger counts of the jobs that are offered there.
+std::vector<std::pair<std::string, int>> OfferedJobs(const Planet &planet, uint64_t seed)
+{
+	Random::Stream stream(seed);
+	PlayerInfo player;
+	player.SetSystem(*planet.GetSystem());
+	player.SetPlanet(&planet);
+	UI ui;
+	// No missions are created when landing just after the game has been loaded.
+	player.Land(ui);
+	player.Land(ui);
+
+	std::vector<std::pair<std::string, int>> jobs;
+	for(const Mission &mission : player.AvailableJobs())
+		jobs.emplace_back(mission.TrueName(), mission.Passengers());
+	return jobs;
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Offering jobs on any number of threads", "[PlayerInfo][CreateMissions]" ) {
+	InjectedJobs jobs;
+	REQUIRE( jobs.injected );
+
+	Set<Wormhole> wormholes;
+	Planet planet;
+	planet.Load(AsDataNode("planet \"Offer Port\"\n\tspaceport \"A place to find work.\""), wormholes, nullptr);
+	Set<Planet> planets;
+	System system;
+	system.Load(AsDataNode("system \"Offer System\"\n\tpos 0 0"), planets, nullptr);
+	planet.SetSystem(&system);
+
+	GIVEN( "jobs whose contents are picked at random" ) {
+		WHEN( "the player lands with the same seed, first on one thread and then on all worker threads" ) {
+			std::vector<std::pair<std::string, int>> serial;
+			{
+				BusyWorkers busy;
+				serial = OfferedJobs(planet, 1234);
+			}
+			const auto parallel = OfferedJobs(planet, 1234);
+
+			THEN( "every job is offered, with the same contents" ) {
+				REQUIRE( serial.size() == 30 );
+				CHECK( parallel == serial );
+			}
+		}
+		WHEN( "the player lands with a different seed" ) {
+			const auto first = OfferedJobs(planet, 1234);
+			const auto second = OfferedJobs(planet, 4321);
+
+			THEN( "the contents of the jobs are different" ) {
+				CHECK( first != second );
+			}
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
@@ -0,0 +1,119 @@
+/* test_profiler.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/Profiler.h"
+
+// ... and any system includes needed for the test file.
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace { // test namespace
+
+// #region mock data
+
+// Count how often the given text occurs in the given string.
+size_t Count(const std::string &text, const std::string &part)
+{
+	size_t count = 0;
+	for(size_t pos = text.find(part); pos != std::string::npos; pos = text.find(part, pos + 1))
+		++count;
+	return count;
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Recording the phases of a frame", "[Profiler]" ) {
+	GIVEN( "a profiler that is turned off" ) {
+		Profiler::SetEnabled(false);
+		{
+			Profiler::Scope scope("test::Disabled");
+		}
+		THEN( "nothing is recorded" ) {
+			std::ostringstream out;
+			Profiler::WriteTrace(out);
+			CHECK( Count(out.str(), "test::Disabled") == 0 );
+		}
+	}
+	GIVEN( "a profiler that is turned on" ) {
+		Profiler::SetEnabled(true);
+		REQUIRE( Profiler::IsEnabled() );
+		{
+			Profiler::Scope outer("test::Outer");
+			Profiler::Scope inner("test::Inner");
+		}
+		std::thread([] { Profiler::Scope scope("test::OtherThread"); }).join();
+		Profiler::SetEnabled(false);
+
+		THEN( "every scope is written as one complete event" ) {
+			std::ostringstream out;
+			Profiler::WriteTrace(out);
+			const std::string trace = out.str();
+			CHECK( trace.find("{\"traceEvents\":[") == 0 );
+			CHECK( Count(trace, "\"name\":\"test::Outer\",\"ph\":\"X\"") == 1 );
+			CHECK( Count(trace, "\"name\":\"test::Inner\",\"ph\":\"X\"") == 1 );
+			CHECK( Count(trace, "\"name\":\"test::OtherThread\",\"ph\":\"X\"") == 1 );
+		}
+		THEN( "events of different threads are written with different thread IDs" ) {
+			std::ostringstream out;
+			Profiler::WriteTrace(out);
+			const std::string trace = out.str();
+			auto ThreadOf = [&trace](const std::string &name)
+			{
+				size_t pos = trace.find("\"tid\":", trace.find(name));
+				return trace.substr(pos, trace.find(',', pos) - pos);
+			};
+			CHECK( ThreadOf("test::Outer") == ThreadOf("test::Inner") );
+			CHECK( ThreadOf("test::Outer") != ThreadOf("test::OtherThread") );
+		}
+	}
+}
+
+SCENARIO( "Adding up the time spent in each phase", "[Profiler]" ) {
+	GIVEN( "phases recorded on several threads" ) {
+		Profiler::SetEnabled(true);
+		Profiler::TakeTotals();
+		{
+			Profiler::Scope scope("test::Total");
+		}
+		std::thread([] { Profiler::Scope scope("test::Total"); }).join();
+		Profiler::SetEnabled(false);
+
+		WHEN( "the totals are taken" ) {
+			const auto totals = Profiler::TakeTotals();
+			THEN( "each phase is listed once, with the time of all its events" ) {
+				REQUIRE( totals.contains("test::Total") );
+				CHECK( totals.at("test::Total") >= 0. );
+				CHECK_FALSE( totals.contains("test::Outer") );
+			}
+			AND_WHEN( "they are taken again" ) {
+				THEN( "the events that were already counted are left out" ) {
+					CHECK( Profiler::TakeTotals().empty() );
+				}
+			}
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
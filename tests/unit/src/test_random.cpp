@@ -19,6 +19,9 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "../../../source/Random.h"
 
 // ... and any system includes needed for the test file.
+#include <cstdint>
+#include <thread>
+#include <vector>
 
 namespace { // test namespace
 
@@ -31,6 +34,47 @@ namespace { // test namespace
 TEST_CASE( "Random::Int", "[random][int]") {
 	REQUIRE( Random::Int(1) == 0 );
 }
+
+SCENARIO( "Drawing numbers from a Random::Stream", "[random][stream]" ) {
+	auto draw = [](uint64_t seed) {
+		Random::Stream stream(seed);
+		std::vector<uint32_t> values;
+		for(int i = 0; i < 16; ++i)
+			values.push_back(Random::Int());
+		return values;
+	};
+	GIVEN( "two streams with the same seed" ) {
+		THEN( "they produce the same numbers" ) {
+			CHECK( draw(42) == draw(42) );
+		}
+		THEN( "the numbers do not depend on the thread drawing them" ) {
+			std::vector<uint32_t> fromThread;
+			std::thread([&draw, &fromThread] { fromThread = draw(42); }).join();
+			CHECK( fromThread == draw(42) );
+		}
+	}
+	GIVEN( "two streams with different seeds" ) {
+		THEN( "they produce different numbers" ) {
+			CHECK( draw(42) != draw(43) );
+		}
+	}
+	GIVEN( "a stream nested inside another" ) {
+		const std::vector<uint32_t> expected = draw(7);
+		std::vector<uint32_t> values;
+		{
+			Random::Stream outer(7);
+			for(int i = 0; i < 8; ++i)
+				values.push_back(Random::Int());
+			draw(1);
+			for(int i = 8; i < 16; ++i)
+				values.push_back(Random::Int());
+		}
+		THEN( "the outer stream resumes where it left off" ) {
+			CHECK( values == expected );
+		}
+	}
+}
+
 // Test code goes here. Preferably, use scenario-driven language making use of the SCENARIO, GIVEN,
 // WHEN, and THEN macros. (There will be cases where the more traditional TEST_CASE and SECTION macros
 // are better suited to declaration of the public API.)
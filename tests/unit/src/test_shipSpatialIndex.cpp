@@ -0,0 +1,132 @@
+/* test_shipSpatialIndex.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/ShipSpatialIndex.h"
+
+// ... and any system includes needed for the test file.
+#include "../../../source/Government.h"
+#include "../../../source/Ship.h"
+
+#include <limits>
+#include <list>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+// Place a new ship of the given government at the given position.
+Ship &AddShip(std::list<Ship> &ships, const Government &government, const Point &position)
+{
+	Ship &ship = ships.emplace_back();
+	ship.SetGovernment(&government);
+	ship.Place(position);
+	return ship;
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Finding ships near a point", "[ShipSpatialIndex]" ) {
+	Government red;
+	Government blue;
+	std::list<Ship> ships;
+	ShipSpatialIndex index(100);
+
+	GIVEN( "ships of two governments spread over several cells" ) {
+		Ship &far = AddShip(ships, red, Point(950., 0.));
+		Ship &near = AddShip(ships, red, Point(30., 40.));
+		Ship &middle = AddShip(ships, red, Point(-150., 200.));
+		Ship &other = AddShip(ships, blue, Point(10., 0.));
+		for(Ship &ship : ships)
+			index.Add(ship);
+		index.Finish();
+
+		THEN( "all ships of a government are listed in the order they were added" ) {
+			CHECK( index.All(&red) == std::vector<Ship *>{&far, &near, &middle} );
+			CHECK( index.All(&blue) == std::vector<Ship *>{&other} );
+		}
+		THEN( "a circle query only returns ships closer than the range, in the order they were added" ) {
+			std::vector<Ship *> result;
+			index.Circle(&red, Point(), 300., result);
+			CHECK( result == std::vector<Ship *>{&near, &middle} );
+		}
+		THEN( "a circle query with an infinite range returns every ship" ) {
+			std::vector<Ship *> result;
+			index.Circle(&red, Point(), std::numeric_limits<double>::infinity(), result);
+			CHECK( result == index.All(&red) );
+		}
+		THEN( "a circle query does not include the range itself" ) {
+			std::vector<Ship *> result;
+			index.Circle(&red, Point(), 50., result);
+			CHECK( result.empty() );
+		}
+		THEN( "a nearest query returns the closest ships first" ) {
+			std::vector<Ship *> result;
+			auto any = [](const Ship &) { return true; };
+			index.Nearest({&red, &blue}, Point(), 3, 10000., any, result);
+			CHECK( result == std::vector<Ship *>{&other, &near, &middle} );
+		}
+		THEN( "a nearest query skips ships that do not pass the filter" ) {
+			std::vector<Ship *> result;
+			auto notNear = [&near](const Ship &ship) { return &ship != &near; };
+			index.Nearest({&red}, Point(), 1, 10000., notNear, result);
+			CHECK( result == std::vector<Ship *>{&middle} );
+		}
+		THEN( "a nearest query only searches the given range" ) {
+			std::vector<Ship *> result;
+			auto any = [](const Ship &) { return true; };
+			index.Nearest({&red}, Point(900., 0.), 2, 100., any, result);
+			CHECK( result == std::vector<Ship *>{&far} );
+		}
+	}
+	GIVEN( "two ships at the same distance" ) {
+		Ship &first = AddShip(ships, red, Point(0., 100.));
+		Ship &second = AddShip(ships, blue, Point(0., -100.));
+		for(Ship &ship : ships)
+			index.Add(ship);
+		index.Finish();
+
+		THEN( "ties are broken by the order of the governments" ) {
+			std::vector<Ship *> result;
+			auto any = [](const Ship &) { return true; };
+			index.Nearest({&blue, &red}, Point(), 2, 10000., any, result);
+			CHECK( result == std::vector<Ship *>{&second, &first} );
+		}
+	}
+	GIVEN( "an index that was cleared" ) {
+		index.Add(AddShip(ships, red, Point()));
+		index.Finish();
+		index.Clear();
+		index.Finish();
+
+		THEN( "it has no ships" ) {
+			std::vector<Ship *> result;
+			index.Circle(&red, Point(), 100., result);
+			CHECK( result.empty() );
+			CHECK( index.All(&red).empty() );
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
@@ -0,0 +1,111 @@
+/* test_taskQueue.cpp
+Copyright (c) 2026 by the Endless Sky developers
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/TaskQueue.h"
+
+// ... and any system includes needed for the test file.
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace { // test namespace
+
+// #region unit tests
+SCENARIO( "Running tasks on the worker threads", "[TaskQueue]" ) {
+	GIVEN( "a queue" ) {
+		TaskQueue queue;
+
+		THEN( "every task is run once it has been waited for" ) {
+			std::atomic<int> count = 0;
+			std::vector<std::shared_future<void>> futures;
+			for(int i = 0; i < 100; ++i)
+				futures.push_back(queue.Run([&count] { ++count; }));
+			queue.Wait();
+			CHECK( count == 100 );
+			for(const std::shared_future<void> &future : futures)
+				CHECK( future.wait_for(std::chrono::seconds(0)) == std::future_status::ready );
+		}
+		THEN( "follow-up tasks are run when processing sync tasks" ) {
+			bool ran = false;
+			queue.Run({}, [&ran] { ran = true; });
+			queue.Wait();
+			CHECK_FALSE( ran );
+			queue.ProcessSyncTasks();
+			CHECK( ran );
+		}
+		THEN( "an exception thrown by a task is rethrown when processing sync tasks" ) {
+			queue.Run([] { throw std::runtime_error("task failed"); });
+			queue.Wait();
+			CHECK_THROWS_AS( queue.ProcessSyncTasks(), std::runtime_error );
+		}
+	}
+}
+
+SCENARIO( "Splitting work over the worker threads", "[TaskQueue]" ) {
+	GIVEN( "a queue" ) {
+		TaskQueue queue(TaskQueue::Priority::HIGH);
+
+		THEN( "every index is visited exactly once, in ranges of at least the given size" ) {
+			std::vector<std::atomic<int>> visits(10000);
+			std::atomic<bool> rangesAreLargeEnough = true;
+			queue.ParallelFor(visits.size(), 64, [&](size_t begin, size_t end)
+			{
+				if(end - begin < 64 && end != visits.size())
+					rangesAreLargeEnough = false;
+				for(size_t i = begin; i < end; ++i)
+					++visits[i];
+			});
+			bool allOnce = true;
+			for(const std::atomic<int> &count : visits)
+				allOnce &= (count == 1);
+			CHECK( allOnce );
+			CHECK( rangesAreLargeEnough );
+		}
+		THEN( "nothing is run for an empty range" ) {
+			bool ran = false;
+			queue.ParallelFor(0, 1, [&ran](size_t, size_t) { ran = true; });
+			CHECK_FALSE( ran );
+		}
+		THEN( "an exception thrown by any range is rethrown" ) {
+			auto Throw = [](size_t begin, size_t end)
+			{
+				if(begin <= 500 && 500 < end)
+					throw std::runtime_error("range failed");
+			};
+			CHECK_THROWS_AS( queue.ParallelFor(1000, 1, Throw), std::runtime_error );
+		}
+		THEN( "a task may split its own work without waiting for a free worker thread" ) {
+			std::atomic<int> count = 0;
+			for(int i = 0; i < 16; ++i)
+				queue.Run([&count]
+				{
+					// Each task needs a queue of its own, since ParallelFor waits for
+					// everything in flight on the queue it is called on.
+					TaskQueue inner(TaskQueue::Priority::HIGH);
+					inner.ParallelFor(100, 1, [&count](size_t begin, size_t end) { count += end - begin; });
+				});
+			queue.Wait();
+			CHECK( count == 1600 );
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace